@@ -44,6 +44,16 @@ async function loadDiagram() {
   renderLegend(data);
   wireInteractivity(svg, data);
   setupPanZoom(svg);
+  showLinkedNode(data);
+}
+
+// Portfolio cards link to their diagram node as /#<node-id>; open its detail
+// panel on arrival so the link lands on something.
+function showLinkedNode(data) {
+  const node = data[decodeURIComponent(location.hash.slice(1))];
+  if (!node) return;
+  showDetail(node, CATEGORIES[node.category] ?? CATEGORIES['planned']);
+  document.getElementById('node-detail').scrollIntoView({ block: 'center' });
 }
 
 // -- Legend --------------------------------------------------------------------
@@ -0,0 +1,164 @@
+// Client-side search over data/search.json.
+//
+// The index is built by tools/sitebuild (see search_index() there): the docs
+// with their text, and a sorted term dictionary of delta-encoded postings.
+// Queries are ranked with BM25. The last query word also matches as a prefix
+// so results keep up while it is still being typed.
+
+// BM25 term-frequency saturation and length normalisation
+const K1 = 1.2;
+const B  = 0.75;
+
+// Characters of context either side of the first hit in a snippet
+const SNIPPET_RADIUS = 80;
+
+// Must match tokenize() in tools/sitebuild.cpp
+const STOPWORDS = new Set([
+  'a', 'an', 'and', 'are', 'as', 'at', 'be', 'but', 'by', 'for', 'if', 'in', 'is', 'it',
+  'of', 'on', 'or', 'so', 'that', 'the', 'this', 'to', 'was', 'with',
+]);
+
+function tokenize(text) {
+  return (text.toLowerCase().match(/[a-z0-9]+/g) ?? []).filter(t => !STOPWORDS.has(t));
+}
+
+// Integer-like keys ("2026") come first in object order, so sort explicitly
+// rather than relying on the order sitebuild wrote them in
+function loadIndex(json) {
+  const terms = Object.keys(json.terms).sort();
+  const avgdl = json.docs.reduce((sum, d) => sum + d.len, 0) / Math.max(json.docs.length, 1);
+  return { docs: json.docs, postings: json.terms, terms, avgdl };
+}
+
+// Dictionary terms starting with prefix, by binary search for the first one
+function withPrefix(index, prefix) {
+  let lo = 0, hi = index.terms.length;
+  while (lo < hi) {
+    const mid = (lo + hi) >> 1;
+    if (index.terms[mid] < prefix) lo = mid + 1; else hi = mid;
+  }
+  const out = [];
+  for (let i = lo; i < index.terms.length && index.terms[i].startsWith(prefix); ++i) {
+    out.push(index.terms[i]);
+  }
+  return out;
+}
+
+// Adds each doc's BM25 contribution for term into scores (doc id -> score)
+function scoreTerm(index, term, scores) {
+  const list = index.postings[term];
+  if (!list) return;
+  const n   = index.docs.length;
+  const df  = list[0];
+  const idf = Math.log(1 + (n - df + 0.5) / (df + 0.5));
+  let doc = 0;
+  for (let i = 1; i < list.length; i += 2) {
+    doc += list[i];
+    const tf   = list[i + 1];
+    const norm = 1 - B + B * index.docs[doc].len / index.avgdl;
+    scores.set(doc, (scores.get(doc) ?? 0) + idf * tf * (K1 + 1) / (tf + K1 * norm));
+  }
+}
+
+// Ranked [{ doc, score, terms }] for a query string
+function search(index, query) {
+  const words = tokenize(query);
+  const total = new Map();
+  const matched = [];
+
+  words.forEach((word, i) => {
+    // A prefix expands to several terms; a doc scores by its best one so a
+    // short prefix doesn't outrank a complete word
+    const terms = i === words.length - 1 ? withPrefix(index, word) : [word];
+    const best = new Map();
+    for (const term of terms) {
+      const scores = new Map();
+      scoreTerm(index, term, scores);
+      for (const [doc, s] of scores) best.set(doc, Math.max(best.get(doc) ?? 0, s));
+    }
+    for (const [doc, s] of best) total.set(doc, (total.get(doc) ?? 0) + s);
+    matched.push(...terms);
+  });
+
+  return [...total]
+    .map(([doc, score]) => ({ doc: index.docs[doc], score, terms: matched }))
+    .sort((a, b) => b.score - a.score);
+}
+
+// Text around the first matched term, with matches wrapped in <mark>. Built
+// from text nodes so nothing in the index is ever parsed as HTML.
+function snippet(text, terms) {
+  const lower = text.toLowerCase();
+  const pattern = new RegExp(`\\b(${terms.map(t => t.replace(/[^a-z0-9]/g, '')).join('|')})`, 'g');
+
+  const first = terms.length ? lower.search(pattern) : -1;
+  const start = Math.max(0, (first < 0 ? 0 : first) - SNIPPET_RADIUS);
+  const end   = Math.min(text.length, (first < 0 ? 0 : first) + SNIPPET_RADIUS * 2);
+
+  const p = document.createElement('p');
+  if (start > 0) p.append('…');
+  let pos = start;
+  for (const m of lower.slice(start, end).matchAll(pattern)) {
+    const at = start + m.index;
+    p.append(text.slice(pos, at));
+    const mark = document.createElement('mark');
+    mark.textContent = text.slice(at, at + m[0].length);
+    p.append(mark);
+    pos = at + m[0].length;
+  }
+  p.append(text.slice(pos, end));
+  if (end < text.length) p.append('…');
+  return p;
+}
+
+function render(results, status, container, elapsed) {
+  container.replaceChildren();
+  status.textContent = `${results.length} result${results.length === 1 ? '' : 's'} (${elapsed.toFixed(2)} ms)`;
+
+  for (const { doc, terms } of results) {
+    const link = document.createElement('a');
+    link.className = 'post-link';
+    link.href = doc.url;
+
+    const title = document.createElement('span');
+    title.className = 'post-title';
+    title.textContent = doc.title;
+    link.append(title, snippet(doc.text, terms));
+
+    const article = document.createElement('article');
+    article.className = 'post-preview';
+    article.append(link);
+    container.append(article);
+  }
+}
+
+async function initSearch() {
+  const input     = document.getElementById('search-input');
+  const status    = document.getElementById('search-status');
+  const container = document.getElementById('search-results');
+
+  input.value = new URLSearchParams(location.search).get('q') ?? '';
+  const index = loadIndex(await fetch('/data/search.json').then(r => r.json()));
+
+  const run = () => {
+    const query = input.value.trim();
+    const url = new URL(location.href);
+    if (query) url.searchParams.set('q', query); else url.searchParams.delete('q');
+    history.replaceState(null, '', url);
+
+    if (!query) {
+      container.replaceChildren();
+      status.textContent = '';
+      return;
+    }
+    const t0 = performance.now();
+    const results = search(index, query);
+    render(results, status, container, performance.now() - t0);
+  };
+
+  input.addEventListener('input', run);
+  input.form.addEventListener('submit', e => { e.preventDefault(); run(); });
+  run();
+}
+
+initSearch();
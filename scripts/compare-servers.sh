@@ -0,0 +1,185 @@
+#!/usr/bin/env bash
+# Runs identical sitebench load against several web servers serving this
+# tree, and prints one comparison table.
+#
+# Always measured:   python3 -m http.server (the devlog's first end-to-end test)
+# If installed:      nginx, caddy, busybox httpd
+# If ORIGIN_CMD set: the C++ origin, e.g.
+#                    ORIGIN_CMD='./origin --port {port} --root {root}' scripts/compare-servers.sh
+#
+# Every server gets the same open-loop schedule (RATE req/s for DURATION
+# seconds over CONNECTIONS connections), so a server that can't keep up shows
+# it as a lower achieved rate and a fatter tail rather than an easier test.
+# File paths are requested literally (--no-clean-urls) because not every
+# server here does clean-URL routing.
+#
+# CPU and RSS are read from /proc for the server process and its children
+# (nginx workers, etc). The table is markdown so it can go straight into a
+# devlog post; it is also written to bench_output.txt.
+
+set -euo pipefail
+
+RATE=${RATE:-1000}
+DURATION=${DURATION:-20}
+CONNECTIONS=${CONNECTIONS:-16}
+PORT=${PORT:-8090}
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+SITEBENCH=$WORK/sitebench
+SERVER_PID=
+
+cleanup() {
+  [[ -n $SERVER_PID ]] && kill "$SERVER_PID" 2>/dev/null || true
+  rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+c++ -std=c++20 -O2 -o "$SITEBENCH" "$ROOT/tools/sitebench.cpp"
+
+# -- Process accounting --------------------------------------------------------
+
+# The server pid followed by all of its descendants
+process_tree() {
+  local pid=$1 child
+  echo "$pid"
+  for child in $(pgrep -P "$pid" || true); do process_tree "$child"; done
+}
+
+# Total user + system CPU time of the tree, in clock ticks
+cpu_ticks() {
+  local pid total=0
+  for pid in $(process_tree "$1"); do
+    # Fields after the parenthesised command name; utime and stime are 14 and 15
+    read -r -a stat < <(sed 's/^.*) //' "/proc/$pid/stat" 2>/dev/null) || continue
+    total=$(( total + stat[11] + stat[12] ))
+  done
+  echo "$total"
+}
+
+# Peak resident set size of the tree, in kB
+peak_rss_kb() {
+  local pid total=0 kb
+  for pid in $(process_tree "$1"); do
+    kb=$(awk '/^VmHWM:/ { print $2 }' "/proc/$pid/status" 2>/dev/null) || continue
+    total=$(( total + ${kb:-0} ))
+  done
+  echo "$total"
+}
+
+wait_for_port() {
+  for _ in $(seq 50); do
+    (exec 3<>"/dev/tcp/127.0.0.1/$PORT") 2>/dev/null && return 0
+    sleep 0.1
+  done
+  return 1
+}
+
+# -- Servers -------------------------------------------------------------------
+
+start_python() {
+  python3 -m http.server "$PORT" --bind 127.0.0.1 --directory "$ROOT" >/dev/null 2>&1 &
+  SERVER_PID=$!
+}
+
+start_nginx() {
+  local mime=/etc/nginx/mime.types
+  cat > "$WORK/nginx.conf" <<EOF
+daemon off;
+worker_processes 1;
+pid $WORK/nginx.pid;
+error_log $WORK/nginx-error.log;
+events {}
+http {
+  $( [[ -f $mime ]] && echo "include $mime;" )
+  access_log off;
+  client_body_temp_path $WORK;
+  server {
+    listen 127.0.0.1:$PORT;
+    root $ROOT;
+  }
+}
+EOF
+  nginx -c "$WORK/nginx.conf" -p "$WORK" >/dev/null 2>&1 &
+  SERVER_PID=$!
+}
+
+start_caddy() {
+  caddy file-server --root "$ROOT" --listen "127.0.0.1:$PORT" >/dev/null 2>&1 &
+  SERVER_PID=$!
+}
+
+start_busybox() {
+  busybox httpd -f -p "127.0.0.1:$PORT" -h "$ROOT" >/dev/null 2>&1 &
+  SERVER_PID=$!
+}
+
+start_origin() {
+  local cmd=${ORIGIN_CMD//\{port\}/$PORT}
+  cmd=${cmd//\{root\}/$ROOT}
+  bash -c "exec $cmd" >/dev/null 2>&1 &
+  SERVER_PID=$!
+}
+
+# -- Measurement ---------------------------------------------------------------
+
+ROWS=()
+
+# Starts a server, loads it, and appends a table row
+measure() {
+  local name=$1 start=$2
+  echo "== $name" >&2
+
+  "$start"
+  if ! wait_for_port; then
+    echo "   did not start listening on port $PORT, skipping" >&2
+    kill "$SERVER_PID" 2>/dev/null || true
+    SERVER_PID=
+    return
+  fi
+
+  local before after report
+  before=$(cpu_ticks "$SERVER_PID")
+  report=$("$SITEBENCH" -R "$RATE" -d "$DURATION" -c "$CONNECTIONS" -r "$ROOT" \
+             --no-clean-urls -o "$WORK/$name.txt" "http://127.0.0.1:$PORT/")
+  after=$(cpu_ticks "$SERVER_PID")
+  local rss_kb
+  rss_kb=$(peak_rss_kb "$SERVER_PID")
+
+  kill "$SERVER_PID" 2>/dev/null || true
+  wait "$SERVER_PID" 2>/dev/null || true
+  SERVER_PID=
+
+  # Pull the numbers back out of sitebench's report
+  local requests rps p50 p99 p999 errors
+  requests=$(awk '/ requests in / { print $1 }' <<< "$report")
+  rps=$(awk '/^Requests\/sec:/ { print $2 }' <<< "$report")
+  p50=$(awk '$1 == "50.000%" { print $2; exit }' <<< "$report")
+  p99=$(awk '$1 == "99.000%" { print $2; exit }' <<< "$report")
+  p999=$(awk '$1 == "99.900%" { print $2; exit }' <<< "$report")
+  errors=$(awk '/^Status:/ { split($4, a, "="); split($5, b, "="); split($6, c, "=") ; n = a[2] + b[2] + c[2] }
+                /^Errors:/ { for (i = 2; i <= NF; i++) { split($i, e, "="); n += e[2] } }
+                END { print n + 0 }' <<< "$report")
+
+  local cpu_us
+  cpu_us=$(awk -v t=$(( after - before )) -v hz="$(getconf CLK_TCK)" -v n="$requests" \
+               'BEGIN { printf "%.1f", (n > 0 ? t / hz * 1e6 / n : 0) }')
+
+  ROWS+=("$(printf '| %-14s | %9s | %8s | %8s | %10s | %8.1f | %12s | %6s |' \
+              "$name" "$rps" "$p50" "$p99" "$p999" "$(awk -v k="$rss_kb" 'BEGIN { print k / 1024 }')" \
+              "$cpu_us" "$errors")")
+}
+
+measure "python3"        start_python
+command -v nginx   >/dev/null && measure "nginx"          start_nginx
+command -v caddy   >/dev/null && measure "caddy"          start_caddy
+command -v busybox >/dev/null && measure "busybox httpd"  start_busybox
+[[ -n ${ORIGIN_CMD:-} ]]      && measure "origin"         start_origin
+
+{
+  echo "Load: ${RATE} req/s for ${DURATION}s over ${CONNECTIONS} connections, $(nproc) CPUs, $(uname -m)"
+  echo
+  echo "| server         |   req/s   | p50 (ms) | p99 (ms) | p99.9 (ms) | RSS (MB) | CPU/req (us) | errors |"
+  echo "|----------------|-----------|----------|----------|------------|----------|--------------|--------|"
+  printf '%s\n' "${ROWS[@]}"
+} | tee "$ROOT/bench_output.txt"
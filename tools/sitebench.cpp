@@ -0,0 +1,1277 @@
+// sitebench - open-loop HTTP load generator for this site.
+//
+// Modelled on wrk2: requests go out on a fixed schedule (constant throughput)
+// instead of as fast as responses come back, and each request's latency is
+// measured from the moment it *should* have been sent. A server that stalls
+// for 100ms therefore shows that stall in every request queued behind it,
+// rather than quietly lowering the request rate ("coordinated omission").
+//
+// The URL mix comes from the served tree itself: every page, the assets each
+// page references (stylesheets, scripts, icons, CSS url()s), and the URLs its
+// scripts fetch() at runtime - e.g. the diagram's SVG and JSON. With
+// --browser, each connection loads a page followed by its subresources in
+// order, the way a browser does over one keep-alive connection. Only the page
+// requests are on the schedule (-R is then page loads per second); each
+// subresource goes out as soon as the previous response is in, so page-load
+// time measures the server rather than the gaps in the schedule.
+//
+// With --replay, the mix comes from an access log instead: each client in the
+// log gets its own connection, its requests go out at their logged times
+// (optionally sped up), and each response is checked against the logged status
+// and size. Real traffic has shapes a synthetic mix misses - scanner bursts,
+// feed polling, crawlers walking every page.
+//
+// With --idle, nothing is timed at all: sitebench opens and holds thousands of
+// idle keep-alive connections - as Cloudflare does to an origin - and reports
+// what each one costs the server in RSS and kernel socket memory, and how
+// much slower a fresh request gets while they are held.
+//
+// Linux only (epoll), no dependencies beyond the standard library.
+//
+//   Build:  c++ -std=c++20 -O2 -o sitebench tools/sitebench.cpp
+//   Usage:  sitebench -R 200 -d 30 -c 16 [--browser] http://127.0.0.1:8000/
+//           sitebench --replay access.log --speed 10 http://127.0.0.1:8000/
+//           sitebench --idle 10000,50000 --pid 1234 --budget 4096 http://127.0.0.1:8000/
+//
+// Results are printed and also written to bench_output.txt (see -o).
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using Clock  = std::chrono::steady_clock;
+
+// -- Options -------------------------------------------------------------------
+
+struct Options {
+  std::string host        = "127.0.0.1";
+  std::string port        = "80";
+  std::string root        = ".";
+  std::string output      = "bench_output.txt";
+  std::string replay;               // access log to replay instead of the URL mix
+  std::vector<std::string> headers;
+  double      rate        = 0;      // requests (--browser: page loads) per second, across all connections
+  double      duration    = 0;      // seconds; 0 = 10s, or the whole log with --replay
+  double      speed       = 1;      // --replay time compression; 0 = as fast as possible
+  std::vector<size_t> idle_levels;  // --idle connection counts to step through
+  int         pid         = 0;      // server process to measure during --idle
+  int64_t     budget      = 0;      // --idle: max server bytes per idle connection, 0 = none
+  double      timeout     = 5;      // seconds before an in-flight request is abandoned
+  int         connections = 8;
+  bool        browser     = false;
+  bool        clean_urls  = true;
+  bool        list_only   = false;
+};
+
+[[noreturn]] void usage(const char* argv0) {
+  std::fprintf(stderr,
+    "usage: %s -R <req/s> [options] http://host[:port]/\n"
+    "       %s --replay <access.log> [--speed <x>] [options] http://host[:port]/\n"
+    "       %s --idle <n>[,<n>...] [--pid <server pid>] [--budget <bytes>] http://host[:port]/\n"
+    "\n"
+    "  -R, --rate <n>         target throughput in requests/second, or page loads/second\n"
+    "                         with --browser (required)\n"
+    "  -d, --duration <s>     test length in seconds (default 10)\n"
+    "  -c, --connections <n>  concurrent connections (default 8)\n"
+    "  -H, --header <h>       extra request header, e.g. 'Accept-Encoding: br'\n"
+    "  -r, --root <dir>       served tree to derive the URL mix from (default .)\n"
+    "  -o, --output <file>    report file (default bench_output.txt)\n"
+    "      --timeout <s>      abandon requests in flight longer than this (default 5)\n"
+    "      --browser          load page + subresources in order per connection\n"
+    "      --no-clean-urls    request /about/index.html rather than /about/\n"
+    "      --list             print the URL mix and exit\n"
+    "      --replay <file>    replay a Common Log Format access log, one connection per client\n"
+    "      --speed <x>        replay at x times the logged pace; 0 = as fast as possible (default 1)\n"
+    "      --idle <n,...>     hold this many idle keep-alive connections, stepping through each count\n"
+    "      --pid <pid>        server process whose memory --idle reports\n"
+    "      --budget <bytes>   --idle fails if the server spends more than this per idle connection\n",
+    argv0, argv0, argv0);
+  std::exit(2);
+}
+
+Options parse_args(int argc, char** argv) {
+  Options opt;
+  std::string url;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view a = argv[i];
+    auto value = [&]() -> const char* {
+      if (i + 1 >= argc) usage(argv[0]);
+      return argv[++i];
+    };
+    if      (a == "-R" || a == "--rate")        opt.rate        = std::atof(value());
+    else if (a == "-d" || a == "--duration")    opt.duration    = std::atof(value());
+    else if (a == "-c" || a == "--connections") opt.connections = std::atoi(value());
+    else if (a == "-H" || a == "--header")      opt.headers.emplace_back(value());
+    else if (a == "-r" || a == "--root")        opt.root        = value();
+    else if (a == "-o" || a == "--output")      opt.output      = value();
+    else if (a == "--timeout")                  opt.timeout     = std::atof(value());
+    else if (a == "--browser")                  opt.browser     = true;
+    else if (a == "--no-clean-urls")            opt.clean_urls  = false;
+    else if (a == "--list")                     opt.list_only   = true;
+    else if (a == "--replay")                   opt.replay      = value();
+    else if (a == "--speed")                    opt.speed       = std::atof(value());
+    else if (a == "--pid")                      opt.pid         = std::atoi(value());
+    else if (a == "--budget")                   opt.budget      = std::atoll(value());
+    else if (a == "--idle") {
+      std::stringstream ss(value());
+      for (std::string n; std::getline(ss, n, ',');) opt.idle_levels.push_back(std::stoul(n));
+      std::sort(opt.idle_levels.begin(), opt.idle_levels.end());
+    }
+    else if (a.starts_with("-"))                usage(argv[0]);
+    else                                        url = a;
+  }
+
+  if (opt.list_only) return opt;
+  if (opt.replay.empty() && opt.duration == 0) opt.duration = 10;
+  if (url.empty() || opt.duration < 0 || opt.speed < 0) usage(argv[0]);
+  if (opt.budget > 0 && opt.pid == 0) usage(argv[0]);
+  const bool scheduled = opt.replay.empty() && opt.idle_levels.empty();
+  if (scheduled && (opt.rate <= 0 || opt.connections <= 0)) usage(argv[0]);
+
+  // Only plain http://host[:port][/] - TLS is Cloudflare's job, not the origin's.
+  constexpr std::string_view scheme = "http://";
+  if (!url.starts_with(scheme)) usage(argv[0]);
+  std::string authority = url.substr(scheme.size());
+  authority = authority.substr(0, authority.find('/'));
+  if (auto colon = authority.rfind(':'); colon != std::string::npos) {
+    opt.host = authority.substr(0, colon);
+    opt.port = authority.substr(colon + 1);
+  } else {
+    opt.host = authority;
+  }
+  return opt;
+}
+
+// -- URL mix -------------------------------------------------------------------
+
+// A page and everything a browser fetches to render it, in document order.
+struct Page {
+  std::string              url;
+  std::vector<std::string> subresources;
+};
+
+std::string read_file(const fs::path& p) {
+  std::ifstream in(p, std::ios::binary);
+  return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+}
+
+// Resolves `ref` against the URL of the document it appeared in, the same way
+// the browser would. Returns "" for anything that isn't a same-origin path.
+std::string resolve(const std::string& base, std::string ref) {
+  if (ref.empty() || ref[0] == '#' || ref.find("://") != std::string::npos ||
+      ref.starts_with("//") || ref.starts_with("data:") || ref.starts_with("mailto:")) {
+    return "";
+  }
+  ref = ref.substr(0, ref.find('#'));
+  std::string joined = ref[0] == '/' ? ref : base.substr(0, base.rfind('/') + 1) + ref;
+
+  // Collapse "." and ".." segments
+  std::vector<std::string> segments;
+  std::stringstream ss(joined);
+  for (std::string seg; std::getline(ss, seg, '/');) {
+    if (seg.empty() || seg == ".") continue;
+    if (seg == "..") { if (!segments.empty()) segments.pop_back(); continue; }
+    segments.push_back(seg);
+  }
+  std::string out;
+  for (const auto& seg : segments) out += "/" + seg;
+  if (out.empty() || joined.back() == '/') out += "/";
+  return out;
+}
+
+// Maps a request path back to the file it is served from.
+fs::path file_for(const fs::path& root, const std::string& url) {
+  std::string path = url.substr(0, url.find('?'));
+  if (path.back() == '/') path += "index.html";
+  fs::path p = root / path.substr(1);
+  if (!fs::exists(p) && fs::exists(fs::path(p).concat(".html"))) p.concat(".html");
+  return p;
+}
+
+// Pages are linked without their .html extension and directories without
+// index.html; that is how real traffic arrives, so that is what we request.
+std::string page_url(const fs::path& rel, bool clean_urls) {
+  std::string s = "/" + rel.generic_string();
+  if (!clean_urls) return s;
+  if (rel.filename() == "index.html") return s.substr(0, s.size() - std::strlen("index.html"));
+  return s.substr(0, s.size() - std::strlen(".html"));
+}
+
+std::vector<Page> discover(const Options& opt) {
+  static const std::regex tag(R"re(<(link|script|img)\b([^>]*)>)re", std::regex::icase);
+  static const std::regex tag_ref(R"re(\b(?:href|src)="([^"]+)")re", std::regex::icase);
+  // <link>s a browser actually downloads; rel="alternate" (feeds) and the like it doesn't
+  static const std::regex fetched_rel(R"re(\brel="(?:stylesheet|icon|preload|modulepreload)")re", std::regex::icase);
+  static const std::regex css_ref(R"re(url\(\s*['"]?([^'")]+)['"]?\s*\))re");
+  static const std::regex js_fetch(R"re(fetch\(\s*['"`]([^'"`]+)['"`])re");
+
+  const fs::path root = opt.root;
+  std::vector<Page> pages;
+
+  for (auto it = fs::recursive_directory_iterator(root); it != fs::recursive_directory_iterator(); ++it) {
+    const fs::path rel  = fs::relative(it->path(), root);
+    const std::string name = rel.filename().string();
+    if (it->is_directory() && (name.starts_with(".") || name.starts_with("_") || name == "tools")) {
+      it.disable_recursion_pending();
+      continue;
+    }
+    // 404.html is what the server sends for misses, not a page anyone navigates to
+    if (!it->is_regular_file() || rel.extension() != ".html" || rel == "404.html") continue;
+
+    Page page{ page_url(rel, opt.clean_urls), {} };
+    std::set<std::string> seen{ page.url };
+    auto add = [&](const std::string& url) {
+      if (!url.empty() && seen.insert(url).second) page.subresources.push_back(url);
+    };
+
+    const std::string html = read_file(it->path());
+    for (std::sregex_iterator t(html.begin(), html.end(), tag), end; t != end; ++t) {
+      std::string name = (*t)[1];
+      std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+      const std::string attrs = (*t)[2];
+      std::smatch m;
+      if (!std::regex_search(attrs, m, tag_ref)) continue;
+      if (name == "link" && !std::regex_search(attrs, fetched_rel)) continue;
+      const std::string url = resolve(page.url, m[1]);
+      if (url.empty()) continue;
+      add(url);
+
+      // Follow one level into the asset: images a stylesheet pulls in, and
+      // whatever a script fetches once it runs. fetch() resolves against the
+      // document, not the script, hence page.url as the base.
+      const fs::path file = file_for(root, url);
+      if (file.extension() == ".css") {
+        const std::string css = read_file(file);
+        for (std::sregex_iterator c(css.begin(), css.end(), css_ref); c != end; ++c) {
+          add(resolve(url, (*c)[1]));
+        }
+      } else if (file.extension() == ".js") {
+        const std::string js = read_file(file);
+        for (std::sregex_iterator f(js.begin(), js.end(), js_fetch); f != end; ++f) {
+          add(resolve(page.url, (*f)[1]));
+        }
+      }
+    }
+    pages.push_back(std::move(page));
+  }
+
+  std::sort(pages.begin(), pages.end(), [](const Page& a, const Page& b) { return a.url < b.url; });
+  return pages;
+}
+
+// -- Access log replay ---------------------------------------------------------
+
+// One request from a Common Log Format access log - the default format of
+// nginx, Apache and python3 -m http.server:
+//
+//   203.0.113.9 - - [17/Oct/2026:18:25:03 +0000] "GET /devlog/ HTTP/1.1" 200 1432
+//
+// (python writes "[17/Oct/2026 18:25:03]", without a zone.) CLF does not
+// record request headers, so Accept-Encoding, If-None-Match and friends can't
+// be reproduced per request; pass representative ones with -H.
+struct LogEntry {
+  std::string client;
+  std::string method;
+  std::string path;
+  double      offset = 0;    // seconds since the first entry
+  int         status = 0;
+  int64_t     bytes  = -1;   // body size, -1 when logged as "-"
+};
+
+struct ReplayLog {
+  std::vector<LogEntry> entries;
+  int64_t skipped = 0;       // unparseable lines and methods other than GET/HEAD
+};
+
+// Parses the bracketed timestamp into seconds since the epoch, or -1.
+int64_t parse_log_time(const std::string& s) {
+  static constexpr std::string_view months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  std::tm tm{};
+  char mon[4] = {};
+  char sign   = '+';
+  int  zh = 0, zm = 0;
+  const int n = std::sscanf(s.c_str(), "%d/%3s/%d%*[: ]%d:%d:%d %c%2d%2d",
+                            &tm.tm_mday, mon, &tm.tm_year, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &sign, &zh, &zm);
+  const size_t m = months.find(mon);
+  if (n < 6 || m == std::string_view::npos) return -1;
+  tm.tm_mon   = static_cast<int>(m / 3);
+  tm.tm_year -= 1900;
+  const int64_t zone = n == 9 ? (sign == '-' ? -1 : 1) * (zh * 3600 + zm * 60) : 0;
+  return static_cast<int64_t>(timegm(&tm)) - zone;
+}
+
+// Splits one CLF line into e, with the bracketed timestamp in time. Walked by
+// hand rather than with std::regex, whose recursive matcher overflows the
+// stack on long lines. The size is digits or "-"; anything else (and anything
+// too long to be a byte count) rejects the line rather than misparsing it.
+bool parse_log_line(std::string_view line, LogEntry& e, std::string& time) {
+  auto field = [&](char end) -> std::optional<std::string_view> {
+    const size_t at = line.find(end);
+    if (at == 0 || at == std::string_view::npos) return std::nullopt;
+    const std::string_view f = line.substr(0, at);
+    line.remove_prefix(at + 1);
+    return f;
+  };
+  auto expect = [&](std::string_view prefix) {
+    if (!line.starts_with(prefix)) return false;
+    line.remove_prefix(prefix.size());
+    return true;
+  };
+  auto digits = [](std::string_view f, size_t max) {
+    return !f.empty() && f.size() <= max &&
+           std::all_of(f.begin(), f.end(), [](char c) { return c >= '0' && c <= '9'; });
+  };
+
+  const auto client = field(' ');
+  if (!client || !field(' ') || !field(' ') || !expect("[")) return false;
+  const auto stamp = field(']');
+  if (!stamp || !expect(" \"")) return false;
+  const auto method = field(' ');
+  if (!method) return false;
+  // The path ends at a space or the closing quote, whichever comes first
+  const size_t quote = line.find('"');
+  const size_t end   = std::min(line.find(' '), quote);
+  if (end == 0 || quote == std::string_view::npos) return false;
+  const std::string_view target = line.substr(0, end);
+  line.remove_prefix(quote + 1);
+  if (!expect(" ")) return false;
+  const auto status = field(' ');
+  if (!status || !digits(*status, 3) || status->size() != 3) return false;
+  const std::string_view size = line.substr(0, line.find_first_of(" \t\r"));
+  if (size != "-" && !digits(size, 18)) return false;
+  if (method->find('"') != std::string_view::npos) return false;
+
+  e = { std::string(*client), std::string(*method), std::string(target), 0,
+        std::stoi(std::string(*status)), size == "-" ? -1 : std::stoll(std::string(size)) };
+  time.assign(*stamp);
+  return true;
+}
+
+ReplayLog load_log(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    std::fprintf(stderr, "sitebench: cannot read %s\n", path.c_str());
+    std::exit(1);
+  }
+
+  ReplayLog log;
+  std::vector<int64_t> seconds;
+  LogEntry e;
+  std::string time;
+  for (std::string line; std::getline(in, line);) {
+    const int64_t t = parse_log_line(line, e, time) ? parse_log_time(time) : -1;
+    if (t < 0 || (e.method != "GET" && e.method != "HEAD")) {
+      ++log.skipped;
+      continue;
+    }
+    log.entries.push_back(std::move(e));
+    seconds.push_back(t);
+  }
+  if (log.entries.empty()) return log;
+
+  // CLF timestamps only have one-second resolution. Spread the requests that
+  // share a second evenly across it instead of firing them as one burst.
+  const int64_t first = *std::min_element(seconds.begin(), seconds.end());
+  for (size_t i = 0; i < seconds.size();) {
+    size_t j = i;
+    while (j < seconds.size() && seconds[j] == seconds[i]) ++j;
+    for (size_t k = i; k < j; ++k) {
+      log.entries[k].offset = static_cast<double>(seconds[k] - first) + static_cast<double>(k - i) / (j - i);
+    }
+    i = j;
+  }
+  return log;
+}
+
+// -- Latency histogram ---------------------------------------------------------
+
+// HDR histogram: log-linear buckets holding 3 significant digits of precision
+// across the whole range, so p99.99 is as exact as p50. Values are microseconds.
+class Histogram {
+ public:
+  static constexpr int kSubBucketBits = 11;                          // 2048 sub-buckets
+  static constexpr int kHalfBits      = kSubBucketBits - 1;
+  static constexpr int64_t kHalfCount = int64_t{1} << kHalfBits;
+  static constexpr int64_t kMask      = (int64_t{1} << kSubBucketBits) - 1;
+  static constexpr int kBuckets       = 40 - kSubBucketBits + 1;     // up to ~2^40 us
+
+  Histogram() : counts_((kBuckets + 1) << kHalfBits, 0) {}
+
+  void record(int64_t v) {
+    v = std::max<int64_t>(v, 0);
+    const size_t i = std::min(index_of(v), counts_.size() - 1);
+    ++counts_[i];
+    ++total_;
+    max_ = std::max(max_, v);
+    sum_ += static_cast<double>(v);
+  }
+
+  int64_t total() const { return total_; }
+  double  mean()  const { return total_ ? sum_ / total_ : 0; }
+  int64_t max()   const { return max_; }
+
+  int64_t percentile(double p) const {
+    if (total_ == 0) return 0;
+    const auto target = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(p / 100.0 * total_)));
+    int64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      seen += counts_[i];
+      if (seen >= target) return std::min(highest_equivalent(i), max_);
+    }
+    return max_;
+  }
+
+ private:
+  static size_t index_of(int64_t v) {
+    const int bucket = 64 - std::countl_zero(static_cast<uint64_t>(v | kMask)) - kSubBucketBits;
+    const int64_t sub = v >> bucket;
+    return static_cast<size_t>(((int64_t{bucket} + 1) << kHalfBits) + (sub - kHalfCount));
+  }
+
+  static int64_t highest_equivalent(size_t i) {
+    int bucket  = static_cast<int>(i >> kHalfBits) - 1;
+    int64_t sub = static_cast<int64_t>(i & (kHalfCount - 1)) + kHalfCount;
+    if (bucket < 0) { sub -= kHalfCount; bucket = 0; }
+    return (sub << bucket) + (int64_t{1} << bucket) - 1;
+  }
+
+  std::vector<int64_t> counts_;
+  int64_t total_ = 0;
+  int64_t max_   = 0;
+  double  sum_   = 0;
+};
+
+// -- Connections ---------------------------------------------------------------
+
+enum class State { Closed, Connecting, Writing, Reading, Idle };
+
+// Incremental HTTP/1.x response reader. Bodies are counted and discarded.
+struct ResponseReader {
+  enum class Phase { Headers, Body, ChunkSize, ChunkData, ChunkCrlf, Trailers, UntilClose, Done, Malformed };
+
+  Phase   phase      = Phase::Headers;
+  int     status     = 0;
+  int64_t remaining  = 0;
+  int64_t body_bytes = 0;
+  bool    keep_alive = true;
+  bool    head       = false;   // response to a HEAD request: never has a body
+  std::string buf;
+
+  void reset(bool head_request) {
+    *this = ResponseReader{};
+    head  = head_request;
+  }
+
+  // Feeds freshly read bytes; returns true once a full response has arrived.
+  // A response that isn't HTTP stops the reader; check malformed().
+  bool feed(const char* data, size_t n) {
+    buf.append(data, n);
+    size_t pos = 0;
+    while (phase != Phase::Done && phase != Phase::Malformed) {
+      if (phase == Phase::Headers) {
+        const size_t end = buf.find("\r\n\r\n", pos);
+        if (end == std::string::npos) break;
+        parse_headers(std::string_view(buf).substr(pos, end - pos));
+        pos = end + 4;
+      } else if (phase == Phase::Body || phase == Phase::ChunkData) {
+        const auto take = std::min<int64_t>(remaining, buf.size() - pos);
+        pos        += take;
+        remaining  -= take;
+        body_bytes += take;
+        if (remaining > 0) break;
+        phase = phase == Phase::Body ? Phase::Done : Phase::ChunkCrlf;
+      } else if (phase == Phase::UntilClose) {
+        body_bytes += buf.size() - pos;
+        pos = buf.size();
+        break;
+      } else {
+        // ChunkSize, ChunkCrlf and Trailers are all line-oriented
+        const size_t eol = buf.find("\r\n", pos);
+        if (eol == std::string::npos) break;
+        const std::string line = buf.substr(pos, eol - pos);
+        pos = eol + 2;
+        if (phase == Phase::ChunkSize) {
+          remaining = std::strtoll(line.c_str(), nullptr, 16);
+          phase = remaining == 0 ? Phase::Trailers : Phase::ChunkData;
+        } else if (phase == Phase::ChunkCrlf) {
+          phase = Phase::ChunkSize;
+        } else if (line.empty()) {
+          phase = Phase::Done;
+        }
+      }
+    }
+    buf.erase(0, pos);
+    return phase == Phase::Done;
+  }
+
+  bool malformed() const { return phase == Phase::Malformed; }
+
+  // The server closed the connection; complete only if the body was delimited by it.
+  bool on_eof() {
+    if (phase == Phase::UntilClose) phase = Phase::Done;
+    return phase == Phase::Done;
+  }
+
+ private:
+  static bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) { return std::tolower(x) == std::tolower(y); });
+  }
+
+  void parse_headers(std::string_view header) {
+    // "HTTP/1.1 200 OK" - anything without a three-digit status isn't a response
+    const std::string_view code = header.substr(std::min<size_t>(9, header.size()), 3);
+    if (!header.starts_with("HTTP/") || header.size() < 12 || header[8] != ' ' ||
+        !std::all_of(code.begin(), code.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+      phase = Phase::Malformed;
+      return;
+    }
+    const bool http10 = header.starts_with("HTTP/1.0");
+    status     = std::atoi(std::string(code).c_str());
+    keep_alive = !http10;
+
+    bool have_length = false, chunked = false;
+    size_t start = header.find("\r\n");
+    while (start != std::string_view::npos) {
+      start += 2;
+      const size_t end  = header.find("\r\n", start);
+      std::string_view line = header.substr(start, end == std::string_view::npos ? end : end - start);
+      start = end;
+
+      const size_t colon = line.find(':');
+      if (colon == std::string_view::npos) continue;
+      std::string_view name  = line.substr(0, colon);
+      std::string_view value = line.substr(colon + 1);
+      while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+
+      if (iequals(name, "content-length")) {
+        have_length = true;
+        remaining   = std::strtoll(std::string(value).c_str(), nullptr, 10);
+      } else if (iequals(name, "transfer-encoding")) {
+        chunked = value.find("chunked") != std::string_view::npos;
+      } else if (iequals(name, "connection")) {
+        if (iequals(value, "close"))      keep_alive = false;
+        if (iequals(value, "keep-alive")) keep_alive = true;
+      }
+    }
+
+    if (head || status == 204 || status == 304 || status / 100 == 1) phase = Phase::Done;
+    else if (chunked)                                         phase = Phase::ChunkSize;
+    else if (have_length)                                     phase = remaining > 0 ? Phase::Body : Phase::Done;
+    else                                                      { phase = Phase::UntilClose; keep_alive = false; }
+  }
+};
+
+struct Connection {
+  int   fd    = -1;
+  State state = State::Closed;
+
+  // Position in this connection's walk through the URL mix
+  size_t page = 0;
+  size_t sub  = 0;   // 0 = the page itself, i = subresources[i - 1]
+
+  // --replay: this client's requests in log order, and the one in flight
+  std::vector<const LogEntry*> script;
+  size_t          next  = 0;
+  const LogEntry* entry = nullptr;
+
+  Clock::time_point next_due;      // when the next request is scheduled to go out
+  Clock::time_point scheduled;     // when the in-flight request was scheduled
+  Clock::time_point sent;          // when it actually started going out (connect included)
+  Clock::time_point page_started;  // --browser: schedule time of the page request
+
+  std::string    out;
+  size_t         written = 0;
+  ResponseReader reader;
+};
+
+struct Stats {
+  Histogram requests;
+  Histogram page_loads;
+  int64_t   bytes          = 0;
+  int64_t   status[6]      = {};
+  int64_t   connect_errors = 0;
+  int64_t   read_errors    = 0;
+  int64_t   timeouts       = 0;
+
+  // --replay: responses that differ from what the log recorded
+  int64_t   status_mismatches = 0;
+  int64_t   size_mismatches   = 0;
+  std::vector<std::string> mismatch_samples;
+};
+
+class Bench {
+ public:
+  Bench(const Options& opt, std::vector<Page> pages, const ReplayLog* replay = nullptr)
+      : opt_(opt), pages_(std::move(pages)), replay_(replay) {
+    // Without --browser every URL is an independent request; flatten the mix
+    // so each one is its own single-entry "page".
+    if (!opt_.browser) {
+      std::vector<Page> flat;
+      for (const auto& p : pages_) {
+        flat.push_back({ p.url, {} });
+        for (const auto& s : p.subresources) flat.push_back({ s, {} });
+      }
+      pages_ = std::move(flat);
+    }
+
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (int rc = getaddrinfo(opt_.host.c_str(), opt_.port.c_str(), &hints, &addr_); rc != 0) {
+      std::fprintf(stderr, "sitebench: %s: %s\n", opt_.host.c_str(), gai_strerror(rc));
+      std::exit(1);
+    }
+    epoll_ = epoll_create1(0);
+
+    std::string host_header = opt_.host;
+    if (opt_.port != "80") host_header += ":" + opt_.port;
+    extra_headers_ = "Host: " + host_header + "\r\nUser-Agent: sitebench\r\n";
+    for (const auto& h : opt_.headers) extra_headers_ += h + "\r\n";
+  }
+
+  ~Bench() {
+    for (auto& c : conns_) if (c.fd >= 0) ::close(c.fd);
+    if (epoll_ >= 0) ::close(epoll_);
+    freeaddrinfo(addr_);
+  }
+
+  void run() {
+    start_ = Clock::now();
+
+    if (replay_) {
+      // One connection per client, so each client's connection reuse is
+      // reproduced rather than spread across a shared pool
+      std::map<std::string, size_t> by_client;
+      for (const auto& e : replay_->entries) {
+        auto [it, added] = by_client.try_emplace(e.client, conns_.size());
+        if (added) conns_.emplace_back();
+        conns_[it->second].script.push_back(&e);
+      }
+      for (auto& c : conns_) c.next_due = due(*c.script.front());
+    } else {
+      // Each connection carries an equal share of the rate; stagger their first
+      // requests across one interval so the combined stream is evenly spaced.
+      interval_ = std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(opt_.connections / opt_.rate));
+      conns_.resize(opt_.connections);
+      for (int i = 0; i < opt_.connections; ++i) {
+        conns_[i].page     = i % pages_.size();
+        conns_[i].next_due = start_ + interval_ * i / opt_.connections;
+      }
+    }
+
+    // A replay without -d runs until every client has finished its script
+    const auto end = opt_.duration > 0
+        ? start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt_.duration))
+        : start_ + std::chrono::hours(24 * 365);
+
+    std::vector<epoll_event> events(conns_.size());
+    for (;;) {
+      const auto now = Clock::now();
+      if (now >= end) break;
+
+      // Kick off anything that is due, and work out how long we may sleep
+      auto wake    = end;
+      bool pending = false;
+      for (auto& c : conns_) {
+        if (c.state == State::Closed || c.state == State::Idle) {
+          if (exhausted(c)) continue;
+          pending = true;
+          if (c.sub > 0 || c.next_due <= now) send_next(c);
+          else                   wake = std::min(wake, c.next_due);
+        } else {
+          pending = true;
+          // The timeout runs from the actual send, so a connection that has
+          // fallen behind schedule still gives each request its full time.
+          // An abandoned request is recorded at its latency so far - a lower
+          // bound, but leaving it out would hide exactly the worst samples.
+          if (now - c.sent > timeout()) {
+            stats_.requests.record(std::chrono::duration_cast<std::chrono::microseconds>(now - c.scheduled).count());
+            ++stats_.timeouts;
+            drop(c);
+          }
+        }
+      }
+      if (!pending) break;
+
+      const auto wait_ms = std::chrono::ceil<std::chrono::milliseconds>(wake - Clock::now()).count();
+      const int n = epoll_wait(epoll_, events.data(), static_cast<int>(events.size()),
+                               static_cast<int>(std::clamp<int64_t>(wait_ms, 0, 100)));
+      for (int i = 0; i < n; ++i) on_event(conns_[events[i].data.u32], events[i].events);
+    }
+    elapsed_ = Clock::now() - start_;
+  }
+
+  std::string report(const std::vector<Page>& mix) const {
+    std::ostringstream r;
+    const double secs = std::chrono::duration<double>(elapsed_).count();
+    const auto& h = stats_.requests;
+    char line[256];
+
+    if (replay_) {
+      r << "sitebench " << opt_.host << ":" << opt_.port << "  mode=replay  speed=";
+      if (opt_.speed > 0) r << opt_.speed << "x\n";
+      else                r << "max\n";
+      r << "Log: " << opt_.replay << ", " << replay_->entries.size() << " requests from "
+        << conns_.size() << " clients, " << replay_->skipped << " lines skipped\n\n";
+    } else {
+      r << "sitebench " << opt_.host << ":" << opt_.port
+        << "  rate=" << opt_.rate << "/s  duration=" << opt_.duration << "s"
+        << "  connections=" << opt_.connections << (opt_.browser ? "  mode=browser" : "  mode=mix") << "\n";
+      size_t urls = 0;
+      for (const auto& p : mix) urls += 1 + p.subresources.size();
+      r << "URL mix: " << mix.size() << " pages, " << urls << " requests per full pass\n\n";
+    }
+
+    auto distribution = [&](const char* title, const Histogram& hist) {
+      r << title << " (ms, measured from scheduled send time)\n";
+      std::snprintf(line, sizeof line, "  %8s %10.3f\n", "mean", hist.mean() / 1000.0);
+      r << line;
+      for (double p : { 50.0, 75.0, 90.0, 99.0, 99.9, 99.99, 99.999, 100.0 }) {
+        std::snprintf(line, sizeof line, "  %7.3f%% %10.3f\n", p, hist.percentile(p) / 1000.0);
+        r << line;
+      }
+      r << "\n";
+    };
+    distribution("Request latency", h);
+    if (opt_.browser) distribution("Page load latency (page + all subresources)", stats_.page_loads);
+
+    std::snprintf(line, sizeof line, "%lld requests in %.2fs, %.2f MB read\n",
+                  static_cast<long long>(h.total()), secs, stats_.bytes / 1e6);
+    r << line;
+    std::snprintf(line, sizeof line, "Requests/sec: %10.2f", h.total() / secs);
+    r << line;
+    if (!replay_ && !opt_.browser) {
+      std::snprintf(line, sizeof line, "  (target %.2f)", opt_.rate);
+      r << line;
+    }
+    r << "\n";
+    if (opt_.browser) {
+      std::snprintf(line, sizeof line, "Pages/sec:    %10.2f  (target %.2f)\n", stats_.page_loads.total() / secs, opt_.rate);
+      r << line;
+    }
+    std::snprintf(line, sizeof line, "Transfer/sec: %10.2f MB\n", stats_.bytes / 1e6 / secs);
+    r << line;
+    r << "Status: 2xx=" << stats_.status[2] << " 3xx=" << stats_.status[3]
+      << " 4xx=" << stats_.status[4] << " 5xx=" << stats_.status[5] << " other=" << stats_.status[0] << "\n";
+    r << "Errors: connect=" << stats_.connect_errors << " read=" << stats_.read_errors
+      << " timeout=" << stats_.timeouts << " (included in latency at the time abandoned)\n";
+    if (replay_) {
+      r << "Mismatches vs log: status=" << stats_.status_mismatches << " size=" << stats_.size_mismatches << "\n";
+      for (const auto& s : stats_.mismatch_samples) r << "  " << s << "\n";
+    }
+    return r.str();
+  }
+
+ private:
+  Clock::duration timeout() const {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(opt_.timeout));
+  }
+
+  const std::string& current_url(const Connection& c) const {
+    const Page& p = pages_[c.page];
+    return c.sub == 0 ? p.url : p.subresources[c.sub - 1];
+  }
+
+  uint32_t index_of(const Connection& c) const { return static_cast<uint32_t>(&c - conns_.data()); }
+
+  // When a logged request should go out. At --speed 0 that is "now": each
+  // client sends its next request as soon as the previous one completes.
+  Clock::time_point due(const LogEntry& e) const {
+    if (opt_.speed == 0) return Clock::now();
+    return start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(e.offset / opt_.speed));
+  }
+
+  bool exhausted(const Connection& c) const { return replay_ && c.next >= c.script.size(); }
+
+  void send_next(Connection& c) {
+    // A subresource isn't scheduled: it follows its predecessor immediately
+    c.scheduled = c.sub > 0 ? Clock::now() : c.next_due;
+
+    if (replay_) {
+      c.entry = c.script[c.next++];
+      c.out   = c.entry->method + " " + c.entry->path + " HTTP/1.1\r\n";
+    } else {
+      if (c.sub == 0) {
+        c.next_due    += interval_;
+        c.page_started = c.scheduled;
+      }
+      c.out = "GET " + current_url(c) + " HTTP/1.1\r\n";
+    }
+    c.out += extra_headers_ + "\r\n";
+    c.written = 0;
+    c.sent    = Clock::now();
+    c.reader.reset(replay_ && c.entry->method == "HEAD");
+
+    if (c.state == State::Closed && !open(c)) return;
+    if (c.state == State::Idle) {
+      c.state = State::Writing;
+      flush(c);
+    }
+  }
+
+  bool open(Connection& c) {
+    c.fd = ::socket(addr_->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+    if (::connect(c.fd, addr_->ai_addr, addr_->ai_addrlen) < 0 && errno != EINPROGRESS) {
+      ++stats_.connect_errors;
+      drop(c);
+      return false;
+    }
+    c.state = State::Connecting;
+    epoll_event ev{ EPOLLOUT | EPOLLIN, { .u32 = index_of(c) } };
+    epoll_ctl(epoll_, EPOLL_CTL_ADD, c.fd, &ev);
+    return true;
+  }
+
+  // Abandons the in-flight request (if any) and moves on to the next URL.
+  void drop(Connection& c) {
+    if (c.fd >= 0) ::close(c.fd);
+    c.fd    = -1;
+    c.state = State::Closed;
+    advance(c);
+  }
+
+  void advance(Connection& c) {
+    if (replay_) {
+      if (!exhausted(c)) c.next_due = due(*c.script[c.next]);
+      return;
+    }
+    const Page& p = pages_[c.page];
+    if (++c.sub > p.subresources.size()) {
+      c.sub  = 0;
+      c.page = (c.page + 1) % pages_.size();
+    }
+  }
+
+  void on_event(Connection& c, uint32_t events) {
+    if (c.state == State::Connecting) {
+      int err = 0;
+      socklen_t len = sizeof err;
+      getsockopt(c.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+      if (err != 0 || (events & (EPOLLERR | EPOLLHUP))) {
+        ++stats_.connect_errors;
+        drop(c);
+        return;
+      }
+      c.state = State::Writing;
+    }
+    if (c.state == State::Writing && (events & EPOLLOUT)) flush(c);
+    if ((c.state == State::Reading || c.state == State::Idle) && (events & (EPOLLIN | EPOLLHUP | EPOLLERR))) read(c);
+  }
+
+  void flush(Connection& c) {
+    while (c.written < c.out.size()) {
+      const ssize_t n = ::send(c.fd, c.out.data() + c.written, c.out.size() - c.written, MSG_NOSIGNAL);
+      if (n < 0) {
+        if (errno == EAGAIN) return;
+        ++stats_.read_errors;
+        drop(c);
+        return;
+      }
+      c.written += n;
+    }
+    c.state = State::Reading;
+    epoll_event ev{ EPOLLIN, { .u32 = index_of(c) } };
+    epoll_ctl(epoll_, EPOLL_CTL_MOD, c.fd, &ev);
+  }
+
+  void read(Connection& c) {
+    char buf[16384];
+    for (;;) {
+      const ssize_t n = ::recv(c.fd, buf, sizeof buf, 0);
+      if (n < 0 && errno == EAGAIN) return;
+
+      // An idle keep-alive connection the server has given up on
+      if (c.state == State::Idle) {
+        ::close(c.fd);
+        c.fd    = -1;
+        c.state = State::Closed;
+        return;
+      }
+      if (n <= 0) {
+        if (n == 0 && c.reader.on_eof()) { complete(c, false); return; }
+        ++stats_.read_errors;
+        drop(c);
+        return;
+      }
+      stats_.bytes += n;
+      if (c.reader.feed(buf, static_cast<size_t>(n))) {
+        complete(c, c.reader.keep_alive);
+        return;
+      }
+      if (c.reader.malformed()) {
+        ++stats_.read_errors;
+        drop(c);
+        return;
+      }
+    }
+  }
+
+  void complete(Connection& c, bool keep_alive) {
+    const auto now = Clock::now();
+    stats_.requests.record(std::chrono::duration_cast<std::chrono::microseconds>(now - c.scheduled).count());
+    const int cls = c.reader.status / 100;
+    ++stats_.status[cls >= 2 && cls <= 5 ? cls : 0];
+
+    if (replay_) {
+      check(*c.entry, c.reader);
+    } else if (opt_.browser && c.sub == pages_[c.page].subresources.size()) {
+      stats_.page_loads.record(std::chrono::duration_cast<std::chrono::microseconds>(now - c.page_started).count());
+    }
+    advance(c);
+
+    if (keep_alive) {
+      c.state = State::Idle;
+      epoll_event ev{ EPOLLIN, { .u32 = index_of(c) } };
+      epoll_ctl(epoll_, EPOLL_CTL_MOD, c.fd, &ev);
+    } else {
+      ::close(c.fd);
+      c.fd    = -1;
+      c.state = State::Closed;
+    }
+  }
+
+  // Compares a replayed response with what the log says the original server sent.
+  void check(const LogEntry& e, const ResponseReader& r) {
+    std::string what;
+    if (r.status != e.status) {
+      ++stats_.status_mismatches;
+      what = "status " + std::to_string(e.status) + " -> " + std::to_string(r.status);
+    } else if (e.bytes >= 0 && e.status == 200 && !r.head && r.body_bytes != e.bytes) {
+      ++stats_.size_mismatches;
+      what = "size " + std::to_string(e.bytes) + " -> " + std::to_string(r.body_bytes);
+    }
+    if (!what.empty() && stats_.mismatch_samples.size() < 10) {
+      stats_.mismatch_samples.push_back(e.method + " " + e.path + ": " + what);
+    }
+  }
+
+  const Options&          opt_;
+  std::vector<Page>       pages_;
+  const ReplayLog*        replay_ = nullptr;
+  std::vector<Connection> conns_;
+  addrinfo*               addr_  = nullptr;
+  int                     epoll_ = -1;
+  std::string             extra_headers_;
+  Clock::duration         interval_{};
+  Clock::time_point       start_;
+  Clock::duration         elapsed_{};
+  Stats                   stats_;
+};
+
+// -- Idle connection soak ------------------------------------------------------
+
+// Resident set size of a process in kB, or -1 if it can't be read.
+int64_t rss_kb(int pid) {
+  std::ifstream in("/proc/" + std::to_string(pid) + "/status");
+  for (std::string line; std::getline(in, line);) {
+    if (line.starts_with("VmRSS:")) return std::atoll(line.c_str() + 6);
+  }
+  return -1;
+}
+
+// Memory the kernel has charged to TCP sockets, system-wide, in kB. On
+// loopback that includes our end of every connection as well as the server's.
+int64_t tcp_mem_kb() {
+  std::ifstream in("/proc/net/sockstat");
+  for (std::string line; std::getline(in, line);) {
+    if (!line.starts_with("TCP:")) continue;
+    const size_t at = line.find(" mem ");
+    if (at != std::string::npos) return std::atoll(line.c_str() + at + 5) * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+  return -1;
+}
+
+class Soak {
+ public:
+  explicit Soak(const Options& opt) : opt_(opt) {
+    addrinfo hints{};
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (int rc = getaddrinfo(opt_.host.c_str(), opt_.port.c_str(), &hints, &addr_); rc != 0) {
+      std::fprintf(stderr, "sitebench: %s: %s\n", opt_.host.c_str(), gai_strerror(rc));
+      std::exit(1);
+    }
+    if (opt_.pid && rss_kb(opt_.pid) < 0) {
+      std::fprintf(stderr, "sitebench: cannot read the memory of pid %d from /proc\n", opt_.pid);
+      std::exit(1);
+    }
+
+    std::string host_header = opt_.host;
+    if (opt_.port != "80") host_header += ":" + opt_.port;
+    request_ = "GET / HTTP/1.1\r\nHost: " + host_header + "\r\nUser-Agent: sitebench\r\n";
+    for (const auto& h : opt_.headers) request_ += h + "\r\n";
+    request_ += "\r\n";
+
+    // 100k connections needs 100k descriptors
+    rlimit lim{};
+    getrlimit(RLIMIT_NOFILE, &lim);
+    lim.rlim_cur = lim.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &lim);
+    max_fds_ = lim.rlim_cur;
+  }
+
+  ~Soak() {
+    for (int fd : held_) ::close(fd);
+    freeaddrinfo(addr_);
+  }
+
+  // Steps through each level, returning false if any exceeded the budget or
+  // couldn't be reached - a level that was never measured can't pass.
+  bool run(std::ostream& out) {
+    char line[256];
+    std::snprintf(line, sizeof line, "%10s %10s %14s %14s %12s %12s %12s\n",
+                  "target", "held", "server RSS kB", "B/conn (user)", "TCP mem kB", "probe p50ms", "probe p99ms");
+    out << line << std::flush;
+
+    const int64_t base_rss = opt_.pid ? rss_kb(opt_.pid) : -1;
+    const int64_t base_tcp = tcp_mem_kb();
+    bool within_budget     = true;
+
+    for (size_t target : opt_.idle_levels) {
+      if (target + 64 > max_fds_) {
+        std::fprintf(stderr, "sitebench: %zu connections exceeds the descriptor limit (%zu)\n", target, max_fds_);
+        within_budget = false;
+        break;
+      }
+      while (held_.size() < target) {
+        const int fd = open_idle(held_.size());
+        if (fd < 0) break;
+        held_.push_back(fd);
+      }
+
+      // Let the server settle, then drop anything it has since closed
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+      reap();
+
+      const Histogram probe = probe_latency();
+      const int64_t rss     = opt_.pid ? rss_kb(opt_.pid) : -1;
+      const int64_t tcp     = tcp_mem_kb();
+      const int64_t per_conn = rss >= 0 && !held_.empty() ? (rss - base_rss) * 1024 / static_cast<int64_t>(held_.size()) : -1;
+
+      std::snprintf(line, sizeof line, "%10zu %10zu %14lld %14lld %12lld %12.3f %12.3f\n",
+                    target, held_.size(), static_cast<long long>(rss), static_cast<long long>(per_conn),
+                    static_cast<long long>(tcp - base_tcp), probe.percentile(50) / 1000.0, probe.percentile(99) / 1000.0);
+      out << line << std::flush;
+
+      // The server may exit mid-run; a level whose memory can't be read
+      // can't be shown to be within the budget either
+      if (opt_.budget > 0 && (base_rss < 0 || rss < 0)) {
+        out << "FAIL: cannot read the memory of pid " << opt_.pid << "\n";
+        within_budget = false;
+        break;
+      }
+      if (opt_.budget > 0 && per_conn > opt_.budget) {
+        out << "FAIL: " << per_conn << " bytes per idle connection exceeds the budget of " << opt_.budget << "\n";
+        within_budget = false;
+      }
+      if (held_.size() < target) {
+        out << "stopped: could only hold " << held_.size() << " connections\n";
+        within_budget = false;
+        break;
+      }
+    }
+    if (primed_closed_ > 0) {
+      out << "\n" << primed_closed_ << " connections were closed by the server after a request; those were\n"
+          << "held open without one instead (the server does not keep connections alive).\n";
+    }
+    return within_budget;
+  }
+
+ private:
+  // Connects, sending from a different loopback address every 20k connections
+  // so a local test isn't capped by one address's ephemeral port range.
+  int connect_to(size_t n) {
+    const int fd = ::socket(addr_->ai_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    const auto* target = reinterpret_cast<const sockaddr_in*>(addr_->ai_addr);
+    if (addr_->ai_family == AF_INET && (ntohl(target->sin_addr.s_addr) >> 24) == 127) {
+      int one = 1;
+      setsockopt(fd, IPPROTO_IP, IP_BIND_ADDRESS_NO_PORT, &one, sizeof one);
+      sockaddr_in source{};
+      source.sin_family      = AF_INET;
+      source.sin_addr.s_addr = htonl((127u << 24) + 10 + static_cast<uint32_t>(n / 20000));
+      ::bind(fd, reinterpret_cast<const sockaddr*>(&source), sizeof source);
+    }
+
+    timeval tv{ 5, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv);
+    if (::connect(fd, addr_->ai_addr, addr_->ai_addrlen) < 0) {
+      ::close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  // Sends one request and reads the whole response; false on any failure.
+  bool exchange(int fd, ResponseReader& reader) {
+    if (::send(fd, request_.data(), request_.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request_.size())) return false;
+    char buf[16384];
+    for (;;) {
+      const ssize_t n = ::recv(fd, buf, sizeof buf, 0);
+      if (n < 0) return false;
+      if (n == 0) return reader.on_eof();
+      if (reader.feed(buf, static_cast<size_t>(n))) return true;
+      if (reader.malformed()) return false;
+    }
+  }
+
+  // An idle connection as Cloudflare leaves one: it has served a request and
+  // is being kept for the next. Servers that close after each response get a
+  // connection that simply hasn't sent anything yet.
+  int open_idle(size_t n) {
+    int fd = connect_to(n);
+    if (fd < 0) return -1;
+    ResponseReader reader;
+    if (exchange(fd, reader) && reader.keep_alive) return fd;
+    ::close(fd);
+    ++primed_closed_;
+    return connect_to(n);
+  }
+
+  // Closes and forgets connections the server has hung up on.
+  void reap() {
+    std::erase_if(held_, [](int fd) {
+      char c;
+      const ssize_t n = ::recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+      if (n < 0 && errno == EAGAIN) return false;
+      ::close(fd);
+      return true;
+    });
+  }
+
+  // Latency of fresh requests while the idle connections are held: a server
+  // that does per-connection work on every loop iteration slows down here.
+  Histogram probe_latency() {
+    Histogram h;
+    for (int i = 0; i < 200; ++i) {
+      const auto start = Clock::now();
+      const int fd = connect_to(held_.size() + i);
+      if (fd < 0) continue;
+      ResponseReader reader;
+      if (exchange(fd, reader)) {
+        h.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+      }
+      ::close(fd);
+    }
+    return h;
+  }
+
+  const Options&   opt_;
+  addrinfo*        addr_ = nullptr;
+  std::string      request_;
+  std::vector<int> held_;
+  size_t           max_fds_       = 0;
+  int64_t          primed_closed_ = 0;
+};
+
+// Writes to two streams at once, so the --idle table appears on the terminal
+// as each level is measured and still ends up in the report file.
+class Tee : public std::streambuf {
+ public:
+  Tee(std::ostream& a, std::ostream& b) : a_(a.rdbuf()), b_(b.rdbuf()) {}
+
+ private:
+  int overflow(int c) override {
+    if (c == traits_type::eof()) return traits_type::not_eof(c);
+    const bool ok = a_->sputc(static_cast<char>(c)) != traits_type::eof() && b_->sputc(static_cast<char>(c)) != traits_type::eof();
+    return ok ? c : traits_type::eof();
+  }
+  std::streamsize xsputn(const char* s, std::streamsize n) override {
+    a_->sputn(s, n);
+    return b_->sputn(s, n);
+  }
+  int sync() override { return a_->pubsync() | b_->pubsync(); }
+
+  std::streambuf* a_;
+  std::streambuf* b_;
+};
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+  const Options opt = parse_args(argc, argv);
+
+  if (!opt.idle_levels.empty()) {
+    Soak soak(opt);
+    std::ofstream file(opt.output);
+    Tee tee(std::cout, file);
+    std::ostream out(&tee);
+    out << "sitebench " << opt.host << ":" << opt.port << "  mode=idle"
+        << (opt.pid ? "  pid=" + std::to_string(opt.pid) : std::string()) << "\n\n" << std::flush;
+
+    const bool ok = soak.run(out);
+    out << std::flush;
+    return ok ? 0 : 1;
+  }
+
+  if (!opt.replay.empty()) {
+    const ReplayLog log = load_log(opt.replay);
+    if (log.entries.empty()) {
+      std::fprintf(stderr, "sitebench: no replayable requests in %s\n", opt.replay.c_str());
+      return 1;
+    }
+    Bench bench(opt, {}, &log);
+    bench.run();
+    const std::string report = bench.report({});
+    std::cout << report;
+    std::ofstream(opt.output) << report;
+    return 0;
+  }
+
+  std::vector<Page> pages = discover(opt);
+  if (pages.empty()) {
+    std::fprintf(stderr, "sitebench: no pages found under %s\n", opt.root.c_str());
+    return 1;
+  }
+
+  if (opt.list_only) {
+    for (const auto& p : pages) {
+      std::cout << p.url << "\n";
+      for (const auto& s : p.subresources) std::cout << "  " << s << "\n";
+    }
+    return 0;
+  }
+
+  Bench bench(opt, pages);
+  bench.run();
+
+  const std::string report = bench.report(pages);
+  std::cout << report;
+  std::ofstream(opt.output) << report;
+  return 0;
+}
@@ -0,0 +1,1933 @@
+// sitebuild - generates the parts of the site that are derived from other files.
+//
+// The site is served as plain files with no build step on the server, so
+// sitebuild runs locally and its outputs are committed alongside their
+// sources:
+//
+//   devlog/posts/*.md  -> the .html next to each, wrapped in
+//                         tools/templates/post.html so the shared head, nav
+//                         and footer live in one place
+//   devlog/index.html  -> the post list, newest first, from every post's
+//                         title and date; plus devlog/page/<n>/ archive pages
+//                         once there are more than kPostsPerPage posts
+//   devlog/feed.xml    -> an Atom feed with every post's full content
+//   data/projects.json -> portfolio/index.html, one card per project, plus
+//                         portfolio/tag/<tag>/ for each tag, wrapped in
+//                         tools/templates/portfolio.html
+//   data/resume.json   -> experience/index.html, wrapped in
+//                         tools/templates/experience.html, and
+//                         experience/resume.pdf, laid out and written
+//                         directly, with links - no browser or LaTeX
+//   data/search.json   -> the inverted index behind /search, over the
+//                         devlog posts, the portfolio, and the experience
+//                         and about pages
+//   sitemap.xml        -> every page's clean URL, with <lastmod> from the
+//                         last commit that changed it
+//
+// Posts start with their metadata in an HTML comment, which keeps the file
+// valid Markdown (GitHub's preview hides it) and keeps GitHub Pages' Jekyll
+// from claiming the file, as it would with --- front matter:
+//
+//   <!--
+//   title: Setting Up Cloudflare and AWS
+//   date: 2026-03-29
+//   description: One sentence for <meta name="description">.
+//   -->
+//
+// Posts compile in parallel, and an output is only rewritten when its bytes
+// change, so an unchanged post keeps its mtime (and its ETag once served).
+//
+//   Build:  c++ -std=c++20 -O2 -pthread -o sitebuild tools/sitebuild.cpp
+//   Usage:  sitebuild [site root]      (default .)
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// -- Files ---------------------------------------------------------------------
+
+std::string read_file(const fs::path& p) {
+  std::ifstream in(p, std::ios::binary);
+  if (!in) {
+    std::fprintf(stderr, "sitebuild: cannot read %s\n", p.string().c_str());
+    std::exit(1);
+  }
+  return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+}
+
+// Writes `content` to `p` unless it already holds exactly that. Returns
+// whether anything was written.
+bool write_if_changed(const fs::path& p, const std::string& content) {
+  if (fs::exists(p) && read_file(p) == content) return false;
+  fs::create_directories(p.parent_path());
+  std::ofstream(p, std::ios::binary) << content;
+  return true;
+}
+
+// Stdout of a shell command; empty if it fails (e.g. no git in a tarball).
+std::string run(const std::string& cmd) {
+  std::string out;
+  FILE* pipe = popen((cmd + " 2>/dev/null").c_str(), "r");
+  if (!pipe) return out;
+  char buf[4096];
+  for (size_t n; (n = std::fread(buf, 1, sizeof buf, pipe)) > 0;) out.append(buf, n);
+  return pclose(pipe) == 0 ? out : std::string();
+}
+
+// -- Text helpers --------------------------------------------------------------
+
+std::string html_escape(std::string_view s) {
+  std::string out;
+  out.reserve(s.size());
+  for (char c : s) {
+    switch (c) {
+      case '&': out += "&amp;";  break;
+      case '<': out += "&lt;";   break;
+      case '>': out += "&gt;";   break;
+      case '"': out += "&quot;"; break;
+      default:  out += c;
+    }
+  }
+  return out;
+}
+
+// The inverse for text lifted out of hand-written markup
+std::string html_unescape(std::string_view s) {
+  static constexpr std::pair<std::string_view, char> entities[] = {
+    { "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&#39;", '\'' },
+  };
+  std::string out;
+  for (size_t i = 0; i < s.size();) {
+    bool matched = false;
+    for (const auto& [entity, c] : entities) {
+      if (s.substr(i).starts_with(entity)) {
+        out += c;
+        i += entity.size();
+        matched = true;
+        break;
+      }
+    }
+    if (!matched) out += s[i++];
+  }
+  return out;
+}
+
+// An <a> to `url` around `inner` (already HTML), with any extra `attrs`.
+// Off-site links open in a new tab, like every external link on the site.
+std::string external_link(std::string_view url, std::string_view inner, std::string_view attrs = "") {
+  const bool external = url.starts_with("http://") || url.starts_with("https://");
+  return "<a href=\"" + html_escape(url) + "\"" + std::string(attrs) +
+         (external ? " target=\"_blank\" rel=\"noopener noreferrer\"" : "") + ">" + std::string(inner) + "</a>";
+}
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+  return s;
+}
+
+std::vector<std::string_view> split_lines(std::string_view s) {
+  std::vector<std::string_view> lines;
+  while (!s.empty()) {
+    const size_t nl = s.find('\n');
+    std::string_view line = s.substr(0, nl);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    lines.push_back(line);
+    if (nl == std::string_view::npos) break;
+    s.remove_prefix(nl + 1);
+  }
+  return lines;
+}
+
+// Prefixes every line of `block` with `n` spaces, except inside <pre>, where
+// whitespace is content.
+std::string indent(std::string_view block, int n) {
+  std::string out;
+  bool pre = false;
+  for (auto line : split_lines(block)) {
+    if (!line.empty() && !pre) out.append(n, ' ');
+    out += line;
+    out += '\n';
+    if (line.find("<pre") != std::string_view::npos) pre = true;
+    if (line.find("</pre>") != std::string_view::npos) pre = false;
+  }
+  return out;
+}
+
+// Substitutes {{name}} placeholders. Values are inserted as-is; callers
+// escape anything that isn't already HTML.
+std::string fill(std::string_view tmpl, const std::map<std::string, std::string>& vars) {
+  std::string out;
+  for (;;) {
+    const size_t open = tmpl.find("{{");
+    const size_t close = open == std::string_view::npos ? open : tmpl.find("}}", open);
+    if (close == std::string_view::npos) break;
+    out += tmpl.substr(0, open);
+    const auto it = vars.find(std::string(tmpl.substr(open + 2, close - open - 2)));
+    if (it != vars.end()) out += it->second;
+    tmpl.remove_prefix(close + 2);
+  }
+  out += tmpl;
+  return out;
+}
+
+// Dates are "YYYY-MM-DD": they sort as strings, and the feed, sitemap and
+// display_date all read them that way.
+bool valid_date(std::string_view iso) {
+  if (iso.size() != 10) return false;
+  for (size_t i = 0; i < iso.size(); ++i) {
+    if (i == 4 || i == 7 ? iso[i] != '-' : !std::isdigit(static_cast<unsigned char>(iso[i]))) return false;
+  }
+  const int m = std::stoi(std::string(iso.substr(5, 2)));
+  const int d = std::stoi(std::string(iso.substr(8, 2)));
+  return m >= 1 && m <= 12 && d >= 1 && d <= 31;
+}
+
+// "2026-03-29" -> "March 29, 2026", matching the hand-written pages
+std::string display_date(const std::string& iso) {
+  static constexpr std::array<const char*, 12> months = {
+    "January", "February", "March", "April", "May", "June",
+    "July", "August", "September", "October", "November", "December",
+  };
+  int y = 0, m = 0, d = 0;
+  if (std::sscanf(iso.c_str(), "%d-%d-%d", &y, &m, &d) != 3 || m < 1 || m > 12) return iso;
+  return std::string(months[m - 1]) + " " + std::to_string(d) + ", " + std::to_string(y);
+}
+
+// The site's canonical origin, from the CNAME GitHub Pages serves it under.
+std::string site_url(const fs::path& root) {
+  return "https://" + std::string(trim(split_lines(read_file(root / "CNAME")).at(0)));
+}
+
+// -- JSON ----------------------------------------------------------------------
+
+// Just enough JSON to read the files in data/: the full grammar, but numbers
+// as doubles and objects kept in file order (which is display order here).
+struct Json {
+  enum class Kind { Null, Bool, Number, String, Array, Object };
+
+  Kind kind = Kind::Null;
+  bool boolean = false;
+  double number = 0;
+  std::string string;
+  std::vector<Json> array;
+  std::vector<std::pair<std::string, Json>> object;
+
+  // Member lookup; a missing key (or a non-object) reads as null
+  const Json& operator[](std::string_view key) const {
+    static const Json null;
+    for (const auto& [k, v] : object) {
+      if (k == key) return v;
+    }
+    return null;
+  }
+  bool is_null() const { return kind == Kind::Null; }
+
+  static Json parse(std::string_view text, const fs::path& source);
+};
+
+class JsonParser {
+public:
+  JsonParser(std::string_view text, const fs::path& source) : text_(text), source_(source) {}
+
+  Json document() {
+    Json v = value();
+    skip_space();
+    if (pos_ != text_.size()) fail("trailing characters");
+    return v;
+  }
+
+private:
+  [[noreturn]] void fail(const char* what) const {
+    const size_t line = std::count(text_.begin(), text_.begin() + std::min(pos_, text_.size()), '\n') + 1;
+    std::fprintf(stderr, "sitebuild: %s:%zu: %s\n", source_.string().c_str(), line, what);
+    std::exit(1);
+  }
+
+  void skip_space() {
+    while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+  }
+
+  bool consume(std::string_view token) {
+    if (!text_.substr(pos_).starts_with(token)) return false;
+    pos_ += token.size();
+    return true;
+  }
+
+  void expect(char c) {
+    skip_space();
+    if (pos_ >= text_.size() || text_[pos_] != c) fail((std::string("expected '") + c + "'").c_str());
+    ++pos_;
+  }
+
+  Json value() {
+    skip_space();
+    if (pos_ >= text_.size()) fail("unexpected end of input");
+    Json v;
+    const char c = text_[pos_];
+    if (c == '{') {
+      v.kind = Json::Kind::Object;
+      ++pos_;
+      skip_space();
+      if (consume("}")) return v;
+      do {
+        skip_space();
+        std::string key = string();
+        expect(':');
+        v.object.emplace_back(std::move(key), value());
+        skip_space();
+      } while (consume(","));
+      expect('}');
+    } else if (c == '[') {
+      v.kind = Json::Kind::Array;
+      ++pos_;
+      skip_space();
+      if (consume("]")) return v;
+      do {
+        v.array.push_back(value());
+        skip_space();
+      } while (consume(","));
+      expect(']');
+    } else if (c == '"') {
+      v.kind = Json::Kind::String;
+      v.string = string();
+    } else if (consume("true")) {
+      v.kind = Json::Kind::Bool;
+      v.boolean = true;
+    } else if (consume("false")) {
+      v.kind = Json::Kind::Bool;
+    } else if (consume("null")) {
+      v.kind = Json::Kind::Null;
+    } else {
+      const char* begin = text_.data() + pos_;
+      char* end = nullptr;
+      v.kind = Json::Kind::Number;
+      v.number = std::strtod(begin, &end);
+      if (end == begin) fail("unexpected character");
+      pos_ += end - begin;
+    }
+    return v;
+  }
+
+  // A string literal, with escapes decoded to UTF-8
+  std::string string() {
+    if (!consume("\"")) fail("expected a string");
+    std::string out;
+    while (true) {
+      if (pos_ >= text_.size()) fail("unterminated string");
+      const char c = text_[pos_++];
+      if (c == '"') return out;
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (pos_ >= text_.size()) fail("unterminated string");
+      switch (const char e = text_[pos_++]; e) {
+        case 'n': out += '\n'; break;
+        case 't': out += '\t'; break;
+        case 'r': out += '\r'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'u': utf8(out, hex4()); break;
+        default:  out += e;
+      }
+    }
+  }
+
+  unsigned hex4() {
+    if (pos_ + 4 > text_.size()) fail("truncated \\u escape");
+    unsigned cp = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char h = text_[pos_++];
+      cp <<= 4;
+      if (h >= '0' && h <= '9')      cp |= h - '0';
+      else if (h >= 'a' && h <= 'f') cp |= h - 'a' + 10;
+      else if (h >= 'A' && h <= 'F') cp |= h - 'A' + 10;
+      else fail("bad \\u escape");
+    }
+    return cp;
+  }
+
+  void utf8(std::string& out, unsigned cp) {
+    // A high surrogate pairs with the \u escape that follows it
+    if (cp >= 0xD800 && cp < 0xDC00 && consume("\\u")) cp = 0x10000 + ((cp - 0xD800) << 10) + (hex4() - 0xDC00);
+    if (cp < 0x80) {
+      out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+      out += static_cast<char>(0xC0 | cp >> 6);
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      out += static_cast<char>(0xE0 | cp >> 12);
+      out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | cp >> 18);
+      out += static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+      out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+  }
+
+  std::string_view text_;
+  const fs::path& source_;
+  size_t pos_ = 0;
+};
+
+Json Json::parse(std::string_view text, const fs::path& source) { return JsonParser(text, source).document(); }
+
+// -- Markdown ------------------------------------------------------------------
+
+// A CommonMark-compatible compiler for the subset posts use: ATX headings,
+// paragraphs, emphasis, code spans, fenced code, links, images, autolinks,
+// block quotes, nested lists, thematic breaks and raw HTML. Not supported:
+// setext headings, indented code blocks, reference links and tables.
+class Markdown {
+ public:
+  // One top-level block. Paragraphs keep their inline HTML separately so
+  // tight list items can drop the <p>.
+  struct Block {
+    enum class Kind { Paragraph, Heading, Code, Other };
+    Kind        kind  = Kind::Other;
+    int         level = 0;     // heading level
+    std::string html;
+    std::string inner;         // paragraph contents
+  };
+
+  static std::vector<Block> blocks(std::string_view src) {
+    const auto lines = split_lines(src);
+    return parse_blocks({ lines.begin(), lines.end() });
+  }
+
+  static std::string render(const std::vector<Block>& blocks) {
+    std::string out;
+    for (const auto& b : blocks) out += b.html + "\n";
+    return out;
+  }
+
+  static std::string inline_html(std::string_view s);
+
+ private:
+  using Lines = std::vector<std::string_view>;
+
+  static bool blank(std::string_view line) { return trim(line).empty(); }
+
+  static size_t leading_spaces(std::string_view line) {
+    const size_t n = line.find_first_not_of(' ');
+    return n == std::string_view::npos ? line.size() : n;
+  }
+
+  static int heading_level(std::string_view line) {
+    line = line.substr(std::min<size_t>(leading_spaces(line), 3));
+    int level = 0;
+    while (level < static_cast<int>(line.size()) && line[level] == '#') ++level;
+    if (level == 0 || level > 6) return 0;
+    return level == static_cast<int>(line.size()) || line[level] == ' ' ? level : 0;
+  }
+
+  static bool thematic_break(std::string_view line) {
+    line = trim(line);
+    if (line.size() < 3 || (line[0] != '-' && line[0] != '*' && line[0] != '_')) return false;
+    int count = 0;
+    for (char c : line) {
+      if (c == line[0]) ++count;
+      else if (c != ' ') return false;
+    }
+    return count >= 3;
+  }
+
+  static std::string_view fence(std::string_view line) {
+    line = line.substr(std::min<size_t>(leading_spaces(line), 3));
+    if (line.starts_with("```")) return line.substr(0, line.find_first_not_of('`'));
+    if (line.starts_with("~~~")) return line.substr(0, line.find_first_not_of('~'));
+    return {};
+  }
+
+  struct ListMarker {
+    bool   ordered = false;
+    char   delim   = 0;     // '-', '*', '+' or the '.' / ')' after a number
+    int    start   = 1;
+    size_t width   = 0;     // columns up to the item's content
+  };
+
+  static bool list_marker(std::string_view line, ListMarker& m) {
+    const size_t lead = leading_spaces(line);
+    if (lead > 3 || thematic_break(line)) return false;
+    size_t i = lead;
+    if (i < line.size() && (line[i] == '-' || line[i] == '*' || line[i] == '+')) {
+      m = { false, line[i], 1, 0 };
+      ++i;
+    } else {
+      size_t digits = 0;
+      while (i + digits < line.size() && digits < 9 && std::isdigit(static_cast<unsigned char>(line[i + digits]))) ++digits;
+      if (digits == 0 || i + digits >= line.size() || (line[i + digits] != '.' && line[i + digits] != ')')) return false;
+      m = { true, line[i + digits], std::atoi(std::string(line.substr(i, digits)).c_str()), 0 };
+      i += digits + 1;
+    }
+    if (i < line.size() && line[i] != ' ') return false;
+    const size_t spaces = std::min<size_t>(leading_spaces(line.substr(i)), 4);
+    m.width = i + (spaces == 0 || spaces == 4 ? 1 : spaces);
+    return true;
+  }
+
+  // Which of CommonMark's HTML block start conditions `line` meets, by its
+  // number in the spec, or 0 for none. Types 1-6 are comments and the like,
+  // raw-text elements, and known block-level tags; type 7 is any other
+  // complete open or close tag alone on its line. Only 1-6 may interrupt a
+  // paragraph, so inline HTML at the start of a paragraph line stays inline,
+  // and an autolink (<https://...>) is never a tag at all. Where each type
+  // ends is html_block_end()'s business.
+  // Whether `line` holds the end marker of an HTML block of type 1-5, which
+  // run through blank lines until it appears - possibly on the start line.
+  // Types 6 and 7 end at a blank line instead.
+  static bool html_block_end(int type, std::string_view line) {
+    std::string lower(line);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    auto has = [&](std::string_view marker) { return lower.find(marker) != std::string::npos; };
+    switch (type) {
+      case 1:  return has("</pre>") || has("</script>") || has("</style>") || has("</textarea>");
+      case 2:  return has("-->");
+      case 3:  return has("?>");
+      case 4:  return has(">");
+      case 5:  return has("]]>");
+      default: return false;
+    }
+  }
+
+  static int html_block_start(std::string_view line) {
+    static const std::set<std::string, std::less<>> raw_text = { "pre", "script", "style", "textarea" };
+    static const std::set<std::string, std::less<>> block_level = {
+      "address", "article", "aside", "blockquote", "body", "caption", "center", "col", "colgroup", "dd",
+      "details", "dialog", "dir", "div", "dl", "dt", "fieldset", "figcaption", "figure", "footer", "form",
+      "h1", "h2", "h3", "h4", "h5", "h6", "head", "header", "hr", "html", "iframe", "legend", "li", "link",
+      "main", "menu", "nav", "ol", "optgroup", "option", "p", "section", "summary", "table", "tbody", "td",
+      "tfoot", "th", "thead", "title", "tr", "ul",
+    };
+
+    line = line.substr(std::min<size_t>(leading_spaces(line), 3));
+    if (!line.starts_with('<')) return 0;
+    if (line.starts_with("<!--")) return 2;
+    if (line.starts_with("<?")) return 3;
+    if (line.starts_with("<![CDATA[")) return 5;
+    if (line.size() > 2 && line[1] == '!' && std::isalpha(static_cast<unsigned char>(line[2]))) return 4;
+
+    size_t i = 1;
+    const bool closing = i < line.size() && line[i] == '/';
+    if (closing) ++i;
+    auto is = [&](size_t k, auto pred) { return k < line.size() && pred(static_cast<unsigned char>(line[k])); };
+    auto name_char = [](unsigned char c) { return std::isalnum(c) || c == '-'; };
+    auto space = [](unsigned char c) { return c == ' ' || c == '\t'; };
+    if (!is(i, [](unsigned char c) { return std::isalpha(c) != 0; })) return 0;
+    const size_t name_start = i;
+    while (is(i, name_char)) ++i;
+    std::string name(line.substr(name_start, i - name_start));
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    // Types 1 and 6 only need the tag name to end
+    const std::string_view after = line.substr(i);
+    const bool name_ends = after.empty() || space(after[0]) || after[0] == '>' || after.starts_with("/>");
+    if (!closing && raw_text.contains(name) && (after.empty() || space(after[0]) || after[0] == '>')) return 1;
+    if (block_level.contains(name) && name_ends) return 6;
+
+    // Type 7: the rest of the tag must parse, and nothing but space follow it
+    if (!closing) {
+      for (;;) {
+        const size_t before = i;
+        while (is(i, space)) ++i;
+        if (i == before || !is(i, [](unsigned char c) { return std::isalpha(c) || c == '_' || c == ':'; })) {
+          i = before;
+          break;
+        }
+        while (is(i, [](unsigned char c) { return std::isalnum(c) || c == '_' || c == '.' || c == ':' || c == '-'; })) ++i;
+        size_t j = i;
+        while (is(j, space)) ++j;
+        if (!is(j, [](unsigned char c) { return c == '='; })) continue;
+        ++j;
+        while (is(j, space)) ++j;
+        if (is(j, [](unsigned char c) { return c == '"' || c == '\''; })) {
+          const size_t end = line.find(line[j], j + 1);
+          if (end == std::string_view::npos) return 0;
+          i = end + 1;
+        } else {
+          const size_t start = j;
+          while (is(j, [](unsigned char c) { return !std::isspace(c) && !std::strchr("\"'=<>`", c); })) ++j;
+          if (j == start) return 0;
+          i = j;
+        }
+      }
+    }
+    while (is(i, space)) ++i;
+    if (!closing && is(i, [](unsigned char c) { return c == '/'; })) ++i;
+    if (!is(i, [](unsigned char c) { return c == '>'; })) return 0;
+    return raw_text.contains(name) || !blank(line.substr(i + 1)) ? 0 : 7;
+  }
+
+  // Whether `line` ends a paragraph without a blank line in between
+  static bool interrupts_paragraph(std::string_view line) {
+    ListMarker m;
+    const int html = html_block_start(line);
+    return heading_level(line) || thematic_break(line) || !fence(line).empty() ||
+           trim(line).starts_with(">") || (html != 0 && html != 7) ||
+           (list_marker(line, m) && (!m.ordered || m.start == 1) && !blank(line.substr(m.width - 1)));
+  }
+
+  static std::vector<Block> parse_blocks(const Lines& lines) {
+    std::vector<Block> out;
+    size_t i = 0;
+    while (i < lines.size()) {
+      const std::string_view line = lines[i];
+      ListMarker marker;
+
+      if (blank(line)) {
+        ++i;
+      } else if (const auto f = fence(line); !f.empty()) {
+        const std::string info(trim(trim(line).substr(f.size())));
+        const size_t strip = leading_spaces(line);
+        std::string code;
+        for (++i; i < lines.size(); ++i) {
+          if (trim(lines[i]).starts_with(f)) { ++i; break; }
+          std::string_view l = lines[i];
+          l.remove_prefix(std::min(strip, leading_spaces(l)));
+          code += html_escape(l) + "\n";
+        }
+        const std::string lang = info.empty() ? "" : " class=\"language-" + html_escape(info.substr(0, info.find(' '))) + "\"";
+        out.push_back({ Block::Kind::Code, 0, "<pre><code" + lang + ">" + code + "</code></pre>", "" });
+      } else if (const int level = heading_level(line)) {
+        std::string_view text = trim(trim(line).substr(level));
+        // Optional closing sequence: "## Title ##"
+        const size_t hashes = text.find_last_not_of('#');
+        if (hashes == std::string_view::npos) text = {};
+        else if (hashes + 1 < text.size() && text[hashes] == ' ') text = trim(text.substr(0, hashes));
+        const std::string tag = "h" + std::to_string(level);
+        out.push_back({ Block::Kind::Heading, level, "<" + tag + ">" + inline_html(text) + "</" + tag + ">", "" });
+        ++i;
+      } else if (thematic_break(line)) {
+        out.push_back({ Block::Kind::Other, 0, "<hr>", "" });
+        ++i;
+      } else if (trim(line).starts_with(">")) {
+        Lines quoted;
+        for (; i < lines.size() && trim(lines[i]).starts_with(">"); ++i) {
+          std::string_view l = trim(lines[i]).substr(1);
+          if (!l.empty() && l[0] == ' ') l.remove_prefix(1);
+          quoted.push_back(l);
+        }
+        out.push_back({ Block::Kind::Other, 0, "<blockquote>\n" + indent(render(parse_blocks(quoted)), 2) + "</blockquote>", "" });
+      } else if (list_marker(line, marker)) {
+        out.push_back(parse_list(lines, i, marker));
+      } else if (const int type = html_block_start(line); type != 0) {
+        std::string html;
+        if (type <= 5) {
+          // Through blank lines to the end marker, or to the end of the post
+          while (i < lines.size()) {
+            html += std::string(lines[i]) + "\n";
+            if (html_block_end(type, lines[i++])) break;
+          }
+        } else {
+          for (; i < lines.size() && !blank(lines[i]); ++i) html += std::string(lines[i]) + "\n";
+        }
+        html.pop_back();
+        out.push_back({ Block::Kind::Other, 0, html, "" });
+      } else {
+        std::string text;
+        for (; i < lines.size() && !blank(lines[i]) && (text.empty() || !interrupts_paragraph(lines[i])); ++i) {
+          // Keep trailing spaces: two of them make a hard line break
+          if (!text.empty()) text += '\n';
+          text += lines[i].substr(std::min(leading_spaces(lines[i]), lines[i].size()));
+        }
+        std::string inner = inline_html(text);
+        out.push_back({ Block::Kind::Paragraph, 0, "<p>\n" + indent(inner, 2) + "</p>", inner });
+      }
+    }
+    return out;
+  }
+
+  // Consumes a list starting at lines[i]; each item's content is parsed as
+  // blocks of its own, which is what makes nesting work.
+  static Block parse_list(const Lines& lines, size_t& i, const ListMarker& first) {
+    std::vector<Lines> items;
+    bool   tight         = true;
+    bool   pending_blank = false;
+    size_t width         = first.width;   // content column of the current item
+
+    ListMarker m;
+    while (i < lines.size()) {
+      const std::string_view line = lines[i];
+      if (blank(line)) {
+        pending_blank = true;
+        items.back().push_back("");
+        ++i;
+        continue;
+      }
+      if (leading_spaces(line) < width && list_marker(line, m) && m.ordered == first.ordered && m.delim == first.delim) {
+        if (pending_blank && !items.empty()) tight = false;
+        items.push_back({ line.substr(std::min(m.width, line.size())) });
+        width         = m.width;
+        pending_blank = false;
+        ++i;
+        continue;
+      }
+      if (leading_spaces(line) >= width) {
+        // Indented continuation - a later paragraph or a nested block
+        if (pending_blank) tight = false;
+        items.back().push_back(line.substr(width));
+      } else if (!pending_blank && !interrupts_paragraph(line)) {
+        // Lazy continuation of the item's paragraph
+        items.back().push_back(trim(line));
+      } else {
+        break;
+      }
+      pending_blank = false;
+      ++i;
+    }
+
+    const std::string tag = first.ordered ? "ol" : "ul";
+    std::string html = "<" + tag;
+    if (first.ordered && first.start != 1) html += " start=\"" + std::to_string(first.start) + "\"";
+    html += ">\n";
+    for (auto& item : items) {
+      while (!item.empty() && blank(item.back())) item.pop_back();
+      const auto content = parse_blocks(item);
+      if (tight && !content.empty() && content.size() <= 2 && content[0].kind == Block::Kind::Paragraph) {
+        // <li>text</li>, with any nested list following directly
+        std::string li = "<li>" + content[0].inner;
+        if (content.size() == 2) li += "\n" + indent(content[1].html, 2);
+        html += indent(li + "</li>", 2);
+      } else {
+        html += indent("<li>\n" + indent(render(content), 2) + "</li>", 2);
+      }
+    }
+    html += "</" + tag + ">";
+    return { Block::Kind::Other, 0, html, "" };
+  }
+};
+
+// Characters that can start inline syntax. Everything else is copied through
+// in bulk, so most of a paragraph is a table lookup per byte and one append.
+static constexpr std::array<bool, 256> kInlineSpecial = [] {
+  std::array<bool, 256> t{};
+  for (unsigned char c : std::string_view("\\`*_[!<>&\"\n")) t[c] = true;
+  return t;
+}();
+
+std::string Markdown::inline_html(std::string_view s) {
+  std::string out;
+  out.reserve(s.size() + s.size() / 8);
+
+  auto is_punct = [](char c) { return std::ispunct(static_cast<unsigned char>(c)) != 0; };
+  auto is_space = [](char c) { return c == ' ' || c == '\n' || c == '\t'; };
+
+  size_t i = 0;
+  while (i < s.size()) {
+    size_t run = i;
+    while (run < s.size() && !kInlineSpecial[static_cast<unsigned char>(s[run])]) ++run;
+    out.append(s.substr(i, run - i));
+    if (run == s.size()) break;
+    i = run;
+    const char c = s[i];
+
+    if (c == '\\' && i + 1 < s.size() && (is_punct(s[i + 1]) || s[i + 1] == '\n')) {
+      if (s[i + 1] == '\n') out += "<br>\n";
+      else                  out += html_escape(s.substr(i + 1, 1));
+      i += 2;
+    } else if (c == '`') {
+      const size_t ticks = s.find_first_not_of('`', i) == std::string_view::npos ? s.size() - i : s.find_first_not_of('`', i) - i;
+      const std::string delim(ticks, '`');
+      size_t close = s.find(delim, i + ticks);
+      // The closing run must be exactly as long as the opening one
+      while (close != std::string_view::npos && close + ticks < s.size() && s[close + ticks] == '`') {
+        close = s.find(delim, s.find_first_not_of('`', close));
+      }
+      if (close == std::string_view::npos) {
+        out += delim;
+        i += ticks;
+        continue;
+      }
+      std::string code(s.substr(i + ticks, close - i - ticks));
+      std::replace(code.begin(), code.end(), '\n', ' ');
+      if (code.size() > 2 && code.front() == ' ' && code.back() == ' ') code = code.substr(1, code.size() - 2);
+      out += "<code>" + html_escape(code) + "</code>";
+      i = close + ticks;
+    } else if (c == '*' || c == '_') {
+      // Delimiter runs, per CommonMark: a run is left-flanking if it isn't
+      // followed by space, and a following punctuation mark is itself
+      // preceded by space or punctuation; right-flanking mirrors that. `_`
+      // additionally can't open or close inside a word.
+      auto run_length = [&](size_t at) {
+        size_t len = 0;
+        while (at + len < s.size() && s[at + len] == c) ++len;
+        return len;
+      };
+      auto can = [&](size_t at, size_t len, bool open) {
+        const char before = at == 0 ? ' ' : s[at - 1];
+        const char after  = at + len >= s.size() ? ' ' : s[at + len];
+        const bool left  = !is_space(after) && (!is_punct(after) || is_space(before) || is_punct(before));
+        const bool right = !is_space(before) && (!is_punct(before) || is_space(after) || is_punct(after));
+        if (open) return left && (c == '*' || !right || is_punct(before));
+        return right && (c == '*' || !left || is_punct(after));
+      };
+
+      // The closer is the first whole run of the same length that can close.
+      // Longer or shorter runs in between belong to nested emphasis, which
+      // the recursive call on the contents pairs up.
+      const size_t n = run_length(i);
+      size_t close = std::string_view::npos;
+      if (n <= 3 && can(i, n, true)) {
+        for (size_t j = i + n; j < s.size();) {
+          if (s[j] == '\\') { j += 2; continue; }
+          if (s[j] != c) { ++j; continue; }
+          const size_t len = run_length(j);
+          if (len == n && can(j, len, false)) { close = j; break; }
+          j += len;
+        }
+      }
+      if (close == std::string_view::npos) {
+        out.append(n, c);
+        i += n;
+        continue;
+      }
+      const std::string inner = inline_html(s.substr(i + n, close - i - n));
+      if (n == 1)      out += "<em>" + inner + "</em>";
+      else if (n == 2) out += "<strong>" + inner + "</strong>";
+      else             out += "<em><strong>" + inner + "</strong></em>";
+      i = close + n;
+    } else if (c == '[' || (c == '!' && i + 1 < s.size() && s[i + 1] == '[')) {
+      const bool image = c == '!';
+      const size_t open = i + (image ? 1 : 0);
+
+      // Matching ']' (brackets may nest), then "(destination "title")"
+      size_t close = std::string_view::npos;
+      for (size_t j = open + 1, depth = 0; j < s.size(); ++j) {
+        if (s[j] == '\\') { ++j; continue; }
+        if (s[j] == '[') ++depth;
+        if (s[j] == ']' && depth-- == 0) { close = j; break; }
+      }
+      // The ')' that balances the '(' - destinations may hold nested
+      // parentheses, e.g. Wikipedia URLs - skipping escapes and a quoted title
+      size_t paren_end = std::string_view::npos;
+      if (close != std::string_view::npos && close + 1 < s.size() && s[close + 1] == '(') {
+        bool quoted = false;
+        for (size_t j = close + 2, depth = 0; j < s.size(); ++j) {
+          if (s[j] == '\\') { ++j; continue; }
+          if (s[j] == '"' && (quoted || is_space(s[j - 1]))) { quoted = !quoted; continue; }
+          if (quoted) continue;
+          if (s[j] == '(') ++depth;
+          if (s[j] == ')' && depth-- == 0) { paren_end = j; break; }
+        }
+      }
+      if (paren_end == std::string_view::npos) {
+        out += image ? "![" : "[";
+        i = open + 1;
+        continue;
+      }
+
+      std::string_view dest = trim(s.substr(close + 2, paren_end - close - 2));
+      std::string_view title;
+      if (const size_t q = dest.find(" \""); q != std::string_view::npos && dest.back() == '"') {
+        title = dest.substr(q + 2, dest.size() - q - 3);
+        dest  = trim(dest.substr(0, q));
+      }
+      if (dest.size() >= 2 && dest.front() == '<' && dest.back() == '>') dest = dest.substr(1, dest.size() - 2);
+
+      const std::string_view text = s.substr(open + 1, close - open - 1);
+      const std::string title_attr = title.empty() ? "" : " title=\"" + html_escape(title) + "\"";
+      if (image) {
+        out += "<img src=\"" + html_escape(dest) + "\" alt=\"" + html_escape(text) + "\"" + title_attr + ">";
+      } else {
+        out += external_link(dest, inline_html(text), title_attr);
+      }
+      i = paren_end + 1;
+    } else if (c == '<') {
+      const size_t close = s.find('>', i);
+      const std::string_view inner = close == std::string_view::npos ? "" : s.substr(i + 1, close - i - 1);
+      const bool autolink = inner.find("://") != std::string_view::npos || inner.starts_with("mailto:");
+      const bool tag = !inner.empty() && (std::isalpha(static_cast<unsigned char>(inner[0])) || inner[0] == '/' || inner[0] == '!');
+      if (autolink && inner.find(' ') == std::string_view::npos) {
+        out += external_link(inner, html_escape(inner));
+        i = close + 1;
+      } else if (tag) {
+        out += s.substr(i, close - i + 1);   // inline HTML passes through
+        i = close + 1;
+      } else {
+        out += "&lt;";
+        ++i;
+      }
+    } else if (c == '&') {
+      // Leave entity references alone; escape a bare ampersand
+      const size_t semi = s.find(';', i);
+      const bool entity = semi != std::string_view::npos && semi - i <= 32 && semi > i + 1 &&
+                          std::all_of(s.begin() + i + 1, s.begin() + semi,
+                                      [](char ch) { return std::isalnum(static_cast<unsigned char>(ch)) || ch == '#'; });
+      out += entity ? std::string(s.substr(i, semi - i + 1)) : "&amp;";
+      i = entity ? semi + 1 : i + 1;
+    } else if (c == '\n') {
+      // Two trailing spaces make a hard break; otherwise a soft one
+      const bool hard = out.size() >= 2 && out.ends_with("  ");
+      while (!out.empty() && out.back() == ' ') out.pop_back();
+      out += hard ? "<br>\n" : "\n";
+      ++i;
+    } else {
+      out += html_escape(s.substr(i, 1));
+      ++i;
+    }
+  }
+  return out;
+}
+
+// -- DevLog posts --------------------------------------------------------------
+
+struct Post {
+  fs::path    source;                 // devlog/posts/<slug>.md, or .html if hand-written
+  std::string slug;
+  std::map<std::string, std::string> meta;
+  std::string content;                // the article body, for the feed
+  std::string html;                   // the compiled page; empty for hand-written posts
+};
+
+// Splits off the leading <!-- key: value --> block.
+std::map<std::string, std::string> read_metadata(std::string_view& src) {
+  std::map<std::string, std::string> meta;
+  const std::string_view body = trim(src.substr(std::min(src.find_first_not_of(" \t\r\n"), src.size())));
+  if (!body.starts_with("<!--")) return meta;
+  const size_t end = body.find("-->");
+  if (end == std::string_view::npos) return meta;
+
+  for (auto line : split_lines(body.substr(4, end - 4))) {
+    const size_t colon = line.find(':');
+    if (colon == std::string_view::npos) continue;
+    meta[std::string(trim(line.substr(0, colon)))] = std::string(trim(line.substr(colon + 1)));
+  }
+  src = body.substr(end + 3);
+  return meta;
+}
+
+// Posts are laid out as one <section> per "##" heading, with anything before
+// the first heading in a section of its own.
+std::string layout_sections(const std::vector<Markdown::Block>& blocks) {
+  std::vector<std::string> sections;
+  for (const auto& b : blocks) {
+    if (sections.empty() || (b.kind == Markdown::Block::Kind::Heading && b.level == 2)) sections.emplace_back();
+    sections.back() += b.html + "\n";
+  }
+  std::string out;
+  for (const auto& s : sections) {
+    if (!out.empty()) out += "\n";
+    out += "<section>\n" + indent(s, 2) + "</section>\n";
+  }
+  out = indent(out, 6);
+  out.pop_back();   // the template supplies the final newline
+  return out;
+}
+
+Post compile_post(const fs::path& root, const fs::path& source, const std::string& tmpl) {
+  Post post{ source, source.stem().string(), {}, {}, {} };
+  const std::string text = read_file(source);
+  std::string_view body  = text;
+  post.meta = read_metadata(body);
+
+  for (const char* key : { "title", "date", "description" }) {
+    if (post.meta[key].empty()) {
+      std::fprintf(stderr, "sitebuild: %s: missing \"%s\" in metadata\n", source.string().c_str(), key);
+      std::exit(1);
+    }
+  }
+  if (!valid_date(post.meta["date"])) {
+    std::fprintf(stderr, "sitebuild: %s: date \"%s\" is not YYYY-MM-DD\n", source.string().c_str(), post.meta["date"].c_str());
+    std::exit(1);
+  }
+
+  post.content = layout_sections(Markdown::blocks(body));
+  post.html = fill(tmpl, {
+    { "source",       fs::relative(source, root).generic_string() },
+    { "title",        html_escape(post.meta["title"]) },
+    { "description",  html_escape(post.meta["description"]) },
+    { "date",         html_escape(post.meta["date"]) },
+    { "date_display", display_date(post.meta["date"]) },
+    { "content",      post.content },
+  });
+  return post;
+}
+
+// Returns the text between the first `open` after `from` and the next `close`.
+std::string between(std::string_view s, std::string_view from, std::string_view open, std::string_view close) {
+  size_t at = s.find(from);
+  if (at == std::string_view::npos) return "";
+  at = s.find(open, at);
+  if (at == std::string_view::npos) return "";
+  at += open.size();
+  const size_t end = s.find(close, at);
+  return end == std::string_view::npos ? "" : std::string(s.substr(at, end - at));
+}
+
+// A post written directly as HTML carries the same metadata in its markup:
+// the header's <h1> and <time datetime>, and the description meta tag.
+Post read_html_post(const fs::path& source) {
+  const std::string html = read_file(source);
+  Post post{ source, source.stem().string(), {}, {}, {} };
+  post.meta["title"]       = html_unescape(between(html, "class=\"post-header\"", "<h1>", "</h1>"));
+  post.meta["date"]        = html_unescape(between(html, "class=\"post-header\"", "<time datetime=\"", "\""));
+  post.meta["description"] = html_unescape(between(html, "<meta name=\"description\"", "content=\"", "\""));
+  post.content             = between(html, "class=\"post-header\"", "</header>", "</article>");
+  if (post.meta["title"].empty() || post.meta["date"].empty()) {
+    std::fprintf(stderr, "sitebuild: %s: no post-header title and date\n", source.string().c_str());
+    std::exit(1);
+  }
+  if (!valid_date(post.meta["date"])) {
+    std::fprintf(stderr, "sitebuild: %s: date \"%s\" is not YYYY-MM-DD\n", source.string().c_str(), post.meta["date"].c_str());
+    std::exit(1);
+  }
+  return post;
+}
+
+// Every post, newest first. Markdown sources are compiled; .html files
+// without a .md beside them are hand-written and only read.
+std::vector<Post> load_posts(const fs::path& root) {
+  const fs::path dir = root / "devlog" / "posts";
+  const std::string tmpl = read_file(root / "tools" / "templates" / "post.html");
+
+  std::vector<fs::path> sources;
+  for (const auto& entry : fs::directory_iterator(dir)) {
+    const fs::path& p = entry.path();
+    if (p.extension() == ".md" || (p.extension() == ".html" && !fs::exists(fs::path(p).replace_extension(".md")))) {
+      sources.push_back(p);
+    }
+  }
+
+  std::vector<std::future<Post>> jobs;
+  for (const auto& src : sources) {
+    if (src.extension() == ".md") jobs.push_back(std::async(std::launch::async, compile_post, std::cref(root), src, std::cref(tmpl)));
+    else                          jobs.push_back(std::async(std::launch::async, read_html_post, src));
+  }
+  std::vector<Post> posts;
+  for (auto& job : jobs) posts.push_back(job.get());
+
+  std::sort(posts.begin(), posts.end(), [](const Post& a, const Post& b) {
+    return std::tie(a.meta.at("date"), a.slug) > std::tie(b.meta.at("date"), b.slug);
+  });
+  return posts;
+}
+
+// -- DevLog index --------------------------------------------------------------
+
+constexpr size_t kPostsPerPage = 10;
+
+// Pagination is anchored at the oldest post: archive page n always holds
+// posts (n-1)*kPostsPerPage+1 through n*kPostsPerPage in publication order,
+// and is only written once it is full. A new post therefore changes
+// devlog/index.html (the newest kPostsPerPage posts) and, every
+// kPostsPerPage posts, adds one archive page - existing pages never shift.
+std::vector<std::pair<fs::path, std::string>> devlog_index(const fs::path& root, const std::vector<Post>& newest_first) {
+  const std::string tmpl = read_file(root / "tools" / "templates" / "devlog-index.html");
+  const std::vector<Post> oldest_first(newest_first.rbegin(), newest_first.rend());
+  const size_t total = oldest_first.size();
+  const size_t full_pages = total / kPostsPerPage;
+
+  auto preview = [](const Post& p) {
+    const std::string& date = p.meta.at("date");
+    return "<article class=\"post-preview\">\n"
+           "  <a class=\"post-link\" href=\"/devlog/posts/" + p.slug + "\">\n"
+           "    <span class=\"post-title\">" + html_escape(p.meta.at("title")) + "</span>\n"
+           "    <time datetime=\"" + html_escape(date) + "\">" + display_date(date) + "</time>\n"
+           "  </a>\n"
+           "</article>\n";
+  };
+
+  // Renders posts [first, last) of oldest_first, newest at the top
+  auto page = [&](const std::string& title, size_t first, size_t last, const std::string& newer, const std::string& older) {
+    std::string list;
+    for (size_t i = last; i-- > first;) list += preview(oldest_first[i]);
+    std::string pager;
+    if (!newer.empty() || !older.empty()) {
+      pager = "<div class=\"pager\">\n";
+      if (!newer.empty()) pager += "  <a class=\"pager-newer\" href=\"" + newer + "\">&larr; Newer posts</a>\n";
+      if (!older.empty()) pager += "  <a class=\"pager-older\" href=\"" + older + "\">Older posts &rarr;</a>\n";
+      pager = indent(pager + "</div>", 4);
+    }
+    std::string posts = indent(list, 6);
+    if (!posts.empty()) posts.pop_back();
+    return fill(tmpl, { { "title", title }, { "posts", posts }, { "pager", pager } });
+  };
+  auto archive_url = [](size_t n) { return "/devlog/page/" + std::to_string(n) + "/"; };
+
+  std::vector<std::pair<fs::path, std::string>> out;
+
+  // The front page: the newest posts, linking to the archive page holding
+  // the newest post that didn't fit
+  const size_t front_first = total > kPostsPerPage ? total - kPostsPerPage : 0;
+  const std::string older = front_first > 0 ? archive_url((front_first - 1) / kPostsPerPage + 1) : "";
+  out.emplace_back(root / "devlog" / "index.html", page("DevLog", front_first, total, "", older));
+
+  for (size_t n = 1; n <= full_pages; ++n) {
+    const std::string newer = n < full_pages ? archive_url(n + 1) : "/devlog/";
+    out.emplace_back(root / "devlog" / "page" / std::to_string(n) / "index.html",
+                     page("DevLog - Page " + std::to_string(n), (n - 1) * kPostsPerPage, n * kPostsPerPage,
+                          newer, n > 1 ? archive_url(n - 1) : ""));
+  }
+  return out;
+}
+
+// -- Atom feed -----------------------------------------------------------------
+
+// Dates are days; the feed states them as midnight UTC.
+std::string atom_time(const std::string& date) { return date + "T00:00:00Z"; }
+
+// The feed is a pure function of the posts - <updated> is the newest post's
+// date, not the build time - so its bytes, and any ETag derived from them,
+// only change when a post does. Feed readers polling it get a 304.
+std::string devlog_feed(const fs::path& root, const std::vector<Post>& newest_first) {
+  const std::string site = site_url(root);
+  const std::string updated = newest_first.empty() ? "1970-01-01" : newest_first.front().meta.at("date");
+
+  std::string xml =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<!-- Generated by tools/sitebuild from the posts in devlog/posts. -->\n"
+    "<feed xmlns=\"http://www.w3.org/2005/Atom\">\n"
+    "  <title>Justin Ottesen - DevLog</title>\n"
+    "  <subtitle>Notes on building this site and other projects.</subtitle>\n"
+    "  <link rel=\"self\" href=\"" + site + "/devlog/feed.xml\"/>\n"
+    "  <link rel=\"alternate\" type=\"text/html\" href=\"" + site + "/devlog\"/>\n"
+    "  <id>" + site + "/devlog</id>\n"
+    "  <updated>" + atom_time(updated) + "</updated>\n"
+    "  <author>\n"
+    "    <name>Justin Ottesen</name>\n"
+    "  </author>\n";
+
+  for (const auto& p : newest_first) {
+    const std::string url  = site + "/devlog/posts/" + p.slug;
+    const std::string date = atom_time(p.meta.at("date"));
+    xml += "  <entry>\n"
+           "    <title>" + html_escape(p.meta.at("title")) + "</title>\n"
+           "    <link rel=\"alternate\" type=\"text/html\" href=\"" + url + "\"/>\n"
+           "    <id>" + url + "</id>\n"
+           "    <published>" + date + "</published>\n"
+           "    <updated>" + date + "</updated>\n";
+    if (!p.meta.at("description").empty()) {
+      xml += "    <summary>" + html_escape(p.meta.at("description")) + "</summary>\n";
+    }
+    // Relative links in the body resolve against the post, not the feed
+    xml += "    <content type=\"html\" xml:base=\"" + url + "\">" + html_escape(p.content) + "</content>\n"
+           "  </entry>\n";
+  }
+  return xml + "</feed>\n";
+}
+
+// -- Portfolio -----------------------------------------------------------------
+
+struct Project {
+  std::string id;
+  std::string title;
+  std::string description;
+  std::string repo;
+  std::string diagram_node;   // id in data/architecture.json, if it's on the home page diagram
+  std::vector<std::string> tags;
+};
+
+std::vector<Project> load_projects(const fs::path& root) {
+  const fs::path source = root / "data" / "projects.json";
+  const Json json = Json::parse(read_file(source), source);
+  const fs::path diagram_source = root / "data" / "architecture.json";
+  const Json diagram = Json::parse(read_file(diagram_source), diagram_source);
+  std::vector<Project> projects;
+  for (const Json& p : json.array) {
+    Project project{ p["id"].string, p["title"].string, p["description"].string, p["repo"].string, p["diagram_node"].string, {} };
+    if (!project.diagram_node.empty() && diagram[project.diagram_node].is_null()) {
+      std::fprintf(stderr, "sitebuild: %s: project \"%s\" names diagram node \"%s\", which %s doesn't have\n",
+                   source.string().c_str(), project.id.c_str(), project.diagram_node.c_str(), diagram_source.string().c_str());
+      std::exit(1);
+    }
+    for (const Json& t : p["tags"].array) project.tags.push_back(t.string);
+
+    // ids are fragment anchors and tags are directory names
+    auto slug = [](const std::string& s) {
+      return !s.empty() && std::all_of(s.begin(), s.end(), [](unsigned char c) {
+        return std::islower(c) || std::isdigit(c) || c == '-';
+      });
+    };
+    if (!slug(project.id) || project.title.empty() || !std::all_of(project.tags.begin(), project.tags.end(), slug)) {
+      std::fprintf(stderr, "sitebuild: %s: project \"%s\" needs a title, and an id and tags of [a-z0-9-]\n",
+                   source.string().c_str(), project.id.c_str());
+      std::exit(1);
+    }
+    projects.push_back(std::move(project));
+  }
+  return projects;
+}
+
+// A set of projects, one bit per index into projects.json
+using ProjectSet = std::uint64_t;
+constexpr size_t kMaxProjects = 64;
+
+// The cards are rendered once each; every page is then its tag's bitset
+// walked in file order, concatenating those fragments. The tag bitsets are
+// also what a multi-tag filter would AND together - with no origin to answer
+// ?tag= queries, each single tag gets a static page at /portfolio/tag/<tag>/.
+std::vector<std::pair<fs::path, std::string>> portfolio(const fs::path& root, const std::vector<Project>& projects) {
+  if (projects.size() > kMaxProjects) {
+    std::fprintf(stderr, "sitebuild: more than %zu projects - widen ProjectSet\n", kMaxProjects);
+    std::exit(1);
+  }
+  const std::string tmpl = read_file(root / "tools" / "templates" / "portfolio.html");
+  auto tag_url = [](const std::string& tag) { return "/portfolio/tag/" + tag + "/"; };
+
+  std::vector<std::string> cards;
+  std::map<std::string, ProjectSet> by_tag;
+  for (size_t i = 0; i < projects.size(); ++i) {
+    const Project& p = projects[i];
+    const std::string title = html_escape(p.title);
+    std::string card = "<article class=\"project\" id=\"" + p.id + "\">\n";
+    card += p.repo.empty() ? "  <h2>" + title + "</h2>\n"
+                           : "  <h2>" + external_link(p.repo, title) + "</h2>\n";
+    card += "  <p>" + html_escape(p.description) + "</p>\n";
+    if (!p.diagram_node.empty()) {
+      card += "  <p class=\"diagram-link\"><a href=\"/#" + html_escape(p.diagram_node) + "\">See it in the architecture diagram</a></p>\n";
+    }
+    if (!p.tags.empty()) {
+      card += "  <p class=\"tags\">\n";
+      for (const auto& t : p.tags) card += "    <a href=\"" + tag_url(t) + "\">" + t + "</a>\n";
+      card += "  </p>\n";
+    }
+    cards.push_back(card + "</article>\n");
+    for (const auto& t : p.tags) by_tag[t] |= ProjectSet{ 1 } << i;
+  }
+
+  auto page = [&](const std::string& title, ProjectSet set, const std::string& current) {
+    std::string bar = "<p class=\"tag-filter\">\n";
+    bar += std::string("  <a href=\"/portfolio/\"") + (current.empty() ? " aria-current=\"page\"" : "") + ">all</a>\n";
+    for (const auto& [tag, members] : by_tag) {
+      bar += "  <a href=\"" + tag_url(tag) + "\"" + (tag == current ? " aria-current=\"page\"" : "") + ">" + tag +
+             " <span>" + std::to_string(std::popcount(members)) + "</span></a>\n";
+    }
+    std::string list;
+    for (size_t i = 0; i < cards.size(); ++i) {
+      if (set >> i & 1) list += cards[i];
+    }
+    std::string tags = indent(bar + "</p>", 6);
+    std::string body = indent(list, 6);
+    tags.pop_back();
+    if (!body.empty()) body.pop_back();
+    return fill(tmpl, { { "title", title }, { "tags", tags }, { "cards", body } });
+  };
+
+  std::vector<std::pair<fs::path, std::string>> out;
+  const ProjectSet all = projects.size() == kMaxProjects ? ~ProjectSet{ 0 } : (ProjectSet{ 1 } << projects.size()) - 1;
+  out.emplace_back(root / "portfolio" / "index.html", page("Portfolio", all, ""));
+  for (const auto& [tag, members] : by_tag) {
+    out.emplace_back(root / "portfolio" / "tag" / tag / "index.html", page("Portfolio - " + tag, members, tag));
+  }
+  return out;
+}
+
+// -- Resume --------------------------------------------------------------------
+
+// data/resume.json, shared by the experience page and the PDF. Projects are
+// listed by id and resolved against data/projects.json, so each is described
+// in one place.
+struct Resume {
+  struct Link {
+    std::string label;
+    std::string url;
+  };
+  struct Entry {
+    std::string organization;
+    std::string url;
+    std::string role;
+    std::string period;   // optional
+    std::vector<std::string> bullets;
+  };
+  struct Skill {
+    std::string category;
+    std::vector<std::string> items;
+  };
+
+  std::string name;
+  std::string summary;
+  std::vector<Link> links;
+  std::vector<Entry> work;
+  std::vector<Entry> education;
+  std::vector<Project> projects;
+  std::vector<Skill> skills;
+};
+
+Resume load_resume(const fs::path& root, const std::vector<Project>& projects) {
+  const fs::path source = root / "data" / "resume.json";
+  const Json json = Json::parse(read_file(source), source);
+
+  auto strings = [](const Json& array) {
+    std::vector<std::string> out;
+    for (const Json& s : array.array) out.push_back(s.string);
+    return out;
+  };
+  auto entries = [&](const Json& array) {
+    std::vector<Resume::Entry> out;
+    for (const Json& e : array.array) {
+      out.push_back({ e["organization"].string, e["url"].string, e["role"].string, e["period"].string, strings(e["bullets"]) });
+    }
+    return out;
+  };
+
+  Resume r;
+  r.name    = json["name"].string;
+  r.summary = json["summary"].string;
+  for (const Json& l : json["links"].array) r.links.push_back({ l["label"].string, l["url"].string });
+  r.work      = entries(json["work"]);
+  r.education = entries(json["education"]);
+  for (const auto& id : strings(json["projects"])) {
+    const auto it = std::find_if(projects.begin(), projects.end(), [&](const Project& p) { return p.id == id; });
+    if (it == projects.end()) {
+      std::fprintf(stderr, "sitebuild: %s: no project \"%s\" in data/projects.json\n", source.string().c_str(), id.c_str());
+      std::exit(1);
+    }
+    r.projects.push_back(*it);
+  }
+  for (const Json& s : json["skills"].array) r.skills.push_back({ s["category"].string, strings(s["items"]) });
+  return r;
+}
+
+// -- PDF -----------------------------------------------------------------------
+
+// Just enough PDF for a resume: text in the Helvetica faces, rules, and link
+// annotations. Helvetica is one of the standard 14 fonts every reader has,
+// so nothing is embedded and the file stays a few kilobytes; its metrics are
+// below for line breaking. There are no timestamps or random IDs, so the
+// same resume always produces the same bytes.
+class Pdf {
+public:
+  enum Font { kRegular, kBold, kOblique };
+
+  static constexpr double kPageWidth  = 612;   // US Letter, in points
+  static constexpr double kPageHeight = 792;
+
+  Pdf() { new_page(); }
+
+  void new_page() { pages_.emplace_back(); }
+
+  // Text is WinAnsi-encoded; see winansi()
+  void text(double x, double y, Font f, double size, std::string_view s) {
+    char buf[96];
+    std::snprintf(buf, sizeof buf, "BT /F%d %.1f Tf %.2f %.2f Td ", f + 1, size, x, y);
+    pages_.back().content += buf + literal(s) + " Tj ET\n";
+  }
+
+  void rule(double x1, double x2, double y, double width) {
+    char buf[128];
+    std::snprintf(buf, sizeof buf, "q 0.6 G %.2f w %.2f %.2f m %.2f %.2f l S Q\n", width, x1, y, x2, y);
+    pages_.back().content += buf;
+  }
+
+  // Makes the rectangle with its lower left at (x, y) a link to uri
+  void link(double x, double y, double w, double h, std::string_view uri) {
+    char buf[96];
+    std::snprintf(buf, sizeof buf, "/Rect [%.2f %.2f %.2f %.2f]", x, y, x + w, y + h);
+    pages_.back().annots.push_back(std::string("<< /Type /Annot /Subtype /Link ") + buf +
+                                   " /Border [0 0 0] /A << /S /URI /URI " + literal(uri) + " >> >>");
+  }
+
+  // Width of WinAnsi text, in points
+  static double width(Font f, std::string_view s, double size) {
+    // Advance widths of 0x20-0x7E, from the Adobe AFM files; Oblique shares Regular's
+    static constexpr std::array<uint16_t, 95> regular = {
+      278, 278, 355, 556, 556, 889, 667, 191, 333, 333, 389, 584, 278, 333, 278, 278,
+      556, 556, 556, 556, 556, 556, 556, 556, 556, 556, 278, 278, 584, 584, 584, 556,
+      1015, 667, 667, 722, 722, 667, 611, 778, 722, 278, 500, 667, 556, 833, 722, 778,
+      667, 778, 722, 667, 611, 722, 667, 944, 667, 667, 611, 278, 278, 278, 469, 556,
+      333, 556, 556, 500, 556, 556, 278, 556, 556, 222, 222, 500, 222, 833, 556, 556,
+      556, 556, 333, 500, 278, 556, 500, 722, 500, 500, 500, 334, 260, 334, 584,
+    };
+    static constexpr std::array<uint16_t, 95> bold = {
+      278, 333, 474, 556, 556, 889, 722, 238, 333, 333, 389, 584, 278, 333, 278, 278,
+      556, 556, 556, 556, 556, 556, 556, 556, 556, 556, 333, 333, 584, 584, 584, 611,
+      975, 722, 722, 722, 722, 667, 611, 778, 722, 278, 556, 722, 611, 833, 722, 778,
+      667, 778, 722, 667, 611, 722, 667, 944, 667, 667, 611, 333, 278, 333, 584, 556,
+      333, 556, 611, 556, 611, 556, 333, 611, 611, 278, 278, 556, 278, 889, 611, 611,
+      611, 611, 389, 556, 333, 611, 556, 778, 556, 556, 500, 389, 280, 389, 584,
+    };
+    double units = 0;
+    for (unsigned char c : s) {
+      if (c >= 0x20 && c <= 0x7E) {
+        units += (f == kBold ? bold : regular)[c - 0x20];
+        continue;
+      }
+      switch (c) {
+        case 0x91: case 0x92: units += f == kBold ? 278 : 222; break;   // single quotes
+        case 0x93: case 0x94: units += f == kBold ? 500 : 333; break;   // double quotes
+        case 0x95: units += 350;  break;                                // bullet
+        case 0x96: units += 556;  break;                                // en dash
+        case 0x97: units += 1000; break;                                // em dash
+        case 0xB7: units += 278;  break;                                // middle dot
+        default:   units += 556;                                        // accented letters, roughly
+      }
+    }
+    return units * size / 1000;
+  }
+
+  // UTF-8 to WinAnsiEncoding, which is what the fonts are declared with.
+  // Covers Latin-1 and the typographic punctuation; anything else becomes '?'.
+  static std::string winansi(std::string_view utf8) {
+    std::string out;
+    for (size_t i = 0; i < utf8.size();) {
+      const unsigned char c = utf8[i];
+      const int len = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+      unsigned cp = len == 1 ? c : c & (0x3F >> (len - 1));
+      for (int k = 1; k < len && i + k < utf8.size(); ++k) cp = cp << 6 | (utf8[i + k] & 0x3F);
+      i += len;
+      switch (cp) {
+        case 0x2018: out += '\x91'; break;
+        case 0x2019: out += '\x92'; break;
+        case 0x201C: out += '\x93'; break;
+        case 0x201D: out += '\x94'; break;
+        case 0x2022: out += '\x95'; break;
+        case 0x2013: out += '\x96'; break;
+        case 0x2014: out += '\x97'; break;
+        default:     out += cp < 0x80 || (cp >= 0xA0 && cp <= 0xFF) ? static_cast<char>(cp) : '?';
+      }
+    }
+    return out;
+  }
+
+  std::string finish(std::string_view title, std::string_view author) const {
+    static constexpr const char* fonts[] = { "Helvetica", "Helvetica-Bold", "Helvetica-Oblique" };
+
+    // Object numbers: 1 catalog, 2 page tree, 3-5 fonts, 6 info, then each
+    // page followed by its content stream and its annotations
+    std::vector<std::string> objects(6);
+    std::string kids;
+    for (const Page& page : pages_) {
+      const size_t id = objects.size() + 1;
+      std::string annots;
+      for (size_t a = 0; a < page.annots.size(); ++a) annots += " " + std::to_string(id + 2 + a) + " 0 R";
+      kids += " " + std::to_string(id) + " 0 R";
+      objects.push_back("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792]"
+                        " /Resources << /Font << /F1 3 0 R /F2 4 0 R /F3 5 0 R >> >>"
+                        " /Contents " + std::to_string(id + 1) + " 0 R /Annots [" + annots + " ] >>");
+      objects.push_back("<< /Length " + std::to_string(page.content.size()) + " >>\nstream\n" + page.content + "endstream");
+      for (const auto& a : page.annots) objects.push_back(a);
+    }
+    objects[0] = "<< /Type /Catalog /Pages 2 0 R >>";
+    objects[1] = "<< /Type /Pages /Kids [" + kids + " ] /Count " + std::to_string(pages_.size()) + " >>";
+    for (int f = 0; f < 3; ++f) {
+      objects[2 + f] = std::string("<< /Type /Font /Subtype /Type1 /BaseFont /") + fonts[f] + " /Encoding /WinAnsiEncoding >>";
+    }
+    objects[5] = "<< /Title " + literal(winansi(title)) + " /Author " + literal(winansi(author)) +
+                 " /Producer (tools/sitebuild) >>";
+
+    // The binary comment marks the file as 8-bit for transfer tools
+    std::string pdf = "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n";
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < objects.size(); ++i) {
+      offsets.push_back(pdf.size());
+      pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+    }
+    const size_t xref = pdf.size();
+    pdf += "xref\n0 " + std::to_string(objects.size() + 1) + "\n0000000000 65535 f \n";
+    for (size_t off : offsets) {
+      char buf[24];
+      std::snprintf(buf, sizeof buf, "%010zu 00000 n \n", off);
+      pdf += buf;
+    }
+    return pdf + "trailer\n<< /Size " + std::to_string(objects.size() + 1) + " /Root 1 0 R /Info 6 0 R >>\n"
+                 "startxref\n" + std::to_string(xref) + "\n%%EOF\n";
+  }
+
+private:
+  struct Page {
+    std::string content;
+    std::vector<std::string> annots;
+  };
+
+  static std::string literal(std::string_view s) {
+    std::string out = "(";
+    for (char c : s) {
+      if (c == '(' || c == ')' || c == '\\') out += '\\';
+      out += c;
+    }
+    return out + ")";
+  }
+
+  std::vector<Page> pages_;
+};
+
+// Lays the resume out top to bottom on US Letter pages, breaking lines
+// greedily at spaces with the font metrics above.
+std::string resume_pdf(const Resume& r) {
+  constexpr double kMargin  = 54;
+  constexpr double kBody    = 10;
+  constexpr double kLeading = 13;
+  constexpr double kIndent  = 12;
+  const double right = Pdf::kPageWidth - kMargin;
+
+  Pdf pdf;
+  double y = Pdf::kPageHeight - kMargin;   // top of the next line
+
+  // Starts a new page unless `height` more points fit on this one
+  auto need = [&](double height) {
+    if (y - height >= kMargin) return;
+    pdf.new_page();
+    y = Pdf::kPageHeight - kMargin;
+  };
+
+  auto wrap = [](const std::string& s, Pdf::Font f, double size, double width) {
+    std::vector<std::string> lines;
+    std::string line;
+    size_t i = 0;
+    while (i < s.size()) {
+      const size_t end = std::min(s.find(' ', i), s.size());
+      const std::string word = s.substr(i, end - i);
+      const std::string candidate = line.empty() ? word : line + " " + word;
+      if (!line.empty() && Pdf::width(f, candidate, size) > width) {
+        lines.push_back(line);
+        line = word;
+      } else {
+        line = candidate;
+      }
+      i = end + 1;
+    }
+    if (!line.empty()) lines.push_back(line);
+    return lines;
+  };
+
+  // Wrapped text starting at x; a non-empty bullet hangs to its left
+  auto paragraph = [&](std::string_view utf8, Pdf::Font f, double size, double x, std::string_view bullet = {}) {
+    bool first = true;
+    for (const auto& line : wrap(Pdf::winansi(utf8), f, size, right - x)) {
+      need(kLeading);
+      y -= kLeading;
+      if (first && !bullet.empty()) pdf.text(x - kIndent + 2, y, Pdf::kRegular, size, bullet);
+      pdf.text(x, y, f, size, line);
+      first = false;
+    }
+  };
+
+  auto heading = [&](std::string title) {
+    std::transform(title.begin(), title.end(), title.begin(), [](unsigned char c) { return std::toupper(c); });
+    y -= 10;
+    need(18 + 2 * kLeading);   // keep a heading with at least its first line
+    y -= 14;
+    pdf.text(kMargin, y, Pdf::kBold, 11, title);
+    y -= 4;
+    pdf.rule(kMargin, right, y, 0.5);
+  };
+
+  // A bold title, linked if it has a url, with `aside` set flush right
+  auto title_line = [&](std::string_view text, std::string_view url, std::string_view aside) {
+    const std::string t = Pdf::winansi(text);
+    need(kLeading + 2);
+    y -= kLeading + 2;
+    pdf.text(kMargin, y, Pdf::kBold, 10.5, t);
+    if (!url.empty()) pdf.link(kMargin, y - 2, Pdf::width(Pdf::kBold, t, 10.5), 12.5, url);
+    if (!aside.empty()) {
+      const std::string a = Pdf::winansi(aside);
+      pdf.text(right - Pdf::width(Pdf::kRegular, a, kBody), y, Pdf::kRegular, kBody, a);
+    }
+  };
+
+  auto entries = [&](const std::vector<Resume::Entry>& list) {
+    for (const auto& e : list) {
+      title_line(e.organization, e.url, e.period);
+      if (!e.role.empty()) paragraph(e.role, Pdf::kOblique, kBody, kMargin);
+      for (const auto& b : e.bullets) paragraph(b, Pdf::kRegular, kBody, kMargin + kIndent, "\x95");
+    }
+  };
+
+  // Name, then the links on one line separated by middle dots
+  y -= 20;
+  pdf.text(kMargin, y, Pdf::kBold, 20, Pdf::winansi(r.name));
+  y -= 16;
+  double x = kMargin;
+  for (size_t i = 0; i < r.links.size(); ++i) {
+    const std::string label = Pdf::winansi(r.links[i].label);
+    const std::string sep = i + 1 < r.links.size() ? "  \xB7  " : "";
+    const double w = Pdf::width(Pdf::kRegular, label, 9.5);
+    pdf.text(x, y, Pdf::kRegular, 9.5, label + sep);
+    pdf.link(x, y - 2, w, 11.5, r.links[i].url);
+    x += Pdf::width(Pdf::kRegular, label + sep, 9.5);
+  }
+  y -= 4;
+  paragraph(r.summary, Pdf::kRegular, kBody, kMargin);
+
+  if (!r.work.empty()) {
+    heading("Experience");
+    entries(r.work);
+  }
+  if (!r.education.empty()) {
+    heading("Education");
+    entries(r.education);
+  }
+  if (!r.projects.empty()) {
+    heading("Projects");
+    for (const auto& p : r.projects) {
+      title_line(p.title, p.repo, "");
+      paragraph(p.description, Pdf::kRegular, kBody, kMargin);
+    }
+  }
+  if (!r.skills.empty()) {
+    heading("Skills");
+    for (const auto& s : r.skills) {
+      std::string items;
+      for (const auto& item : s.items) items += (items.empty() ? "" : ", ") + item;
+      const std::string label = Pdf::winansi(s.category + ":");
+      const double offset = Pdf::width(Pdf::kBold, label, kBody) + 4;
+      need(kLeading);
+      pdf.text(kMargin, y - kLeading, Pdf::kBold, kBody, label);
+      paragraph(items, Pdf::kRegular, kBody, kMargin + offset);
+    }
+  }
+
+  return pdf.finish(r.name + " - Resume", r.name);
+}
+
+// -- Experience page -----------------------------------------------------------
+
+// The HTML twin of resume_pdf(): same Resume, same section order, so the
+// page and the download can't drift apart.
+std::string experience_page(const fs::path& root, const Resume& r) {
+  const std::string tmpl = read_file(root / "tools" / "templates" / "experience.html");
+
+  std::string links = "<p class=\"resume-links\">\n";
+  for (const auto& l : r.links) links += "  " + external_link(l.url, html_escape(l.label)) + "\n";
+  links += "  <a href=\"/experience/resume.pdf\">Resume (PDF)</a>\n</p>";
+
+  auto entries = [](const std::string& title, const std::vector<Resume::Entry>& list) {
+    std::string html = "<section>\n  <h2>" + title + "</h2>\n";
+    for (const auto& e : list) {
+      const std::string org = html_escape(e.organization);
+      html += "  <article class=\"resume-entry\">\n    <div class=\"resume-entry-title\">\n";
+      html += e.url.empty() ? "      <h3>" + org + "</h3>\n"
+                            : "      <h3>" + external_link(e.url, org) + "</h3>\n";
+      if (!e.period.empty()) html += "      <span>" + html_escape(e.period) + "</span>\n";
+      html += "    </div>\n";
+      if (!e.role.empty()) html += "    <p class=\"resume-role\">" + html_escape(e.role) + "</p>\n";
+      if (!e.bullets.empty()) {
+        html += "    <ul>\n";
+        for (const auto& b : e.bullets) html += "      <li>" + html_escape(b) + "</li>\n";
+        html += "    </ul>\n";
+      }
+      html += "  </article>\n";
+    }
+    return html + "</section>\n";
+  };
+
+  std::string sections;
+  if (!r.work.empty()) sections += entries("Work", r.work);
+  if (!r.education.empty()) sections += entries("Education", r.education);
+  if (!r.projects.empty()) {
+    sections += "<section>\n  <h2>Projects</h2>\n";
+    for (const auto& p : r.projects) {
+      sections += "  <article class=\"resume-entry\">\n"
+                  "    <h3><a href=\"/portfolio/#" + p.id + "\">" + html_escape(p.title) + "</a></h3>\n"
+                  "    <p>" + html_escape(p.description) + "</p>\n"
+                  "  </article>\n";
+    }
+    sections += "</section>\n";
+  }
+  if (!r.skills.empty()) {
+    sections += "<section>\n  <h2>Skills</h2>\n  <dl class=\"skills\">\n";
+    for (const auto& s : r.skills) {
+      std::string items;
+      for (const auto& item : s.items) items += (items.empty() ? "" : ", ") + html_escape(item);
+      sections += "    <dt>" + html_escape(s.category) + "</dt>\n    <dd>" + items + "</dd>\n";
+    }
+    sections += "  </dl>\n</section>\n";
+  }
+
+  std::string head = indent(links, 6);
+  std::string body = indent(sections, 4);
+  head.pop_back();
+  if (!body.empty()) body.pop_back();
+  return fill(tmpl, { { "summary", html_escape(r.summary) }, { "links", head }, { "sections", body } });
+}
+
+// -- Search index --------------------------------------------------------------
+
+// Visible text of an HTML fragment: tags dropped (and <nav>, <script> etc.
+// with their contents), common entities decoded, whitespace collapsed.
+std::string html_text(std::string_view html) {
+  std::string raw;
+  size_t i = 0;
+  while (i < html.size()) {
+    if (html[i] != '<') {
+      raw += html[i++];
+      continue;
+    }
+    const size_t end = html.find('>', i);
+    if (end == std::string_view::npos) break;
+    std::string name(html.substr(i + 1, end - i - 1));
+    name = name.substr(0, name.find_first_of(" \t\n/"));
+    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+    i = end + 1;
+    if (name == "nav" || name == "script" || name == "style" || name == "footer" || name == "header") {
+      const size_t close = html.find("</" + name, i);
+      i = close == std::string_view::npos ? html.size() : html.find('>', close) + 1;
+    }
+    raw += ' ';
+  }
+
+  std::string out;
+  for (char c : html_unescape(raw)) {
+    const bool space = c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    if (space && (out.empty() || out.back() == ' ')) continue;
+    out += space ? ' ' : c;
+  }
+  if (!out.empty() && out.back() == ' ') out.pop_back();
+  return out;
+}
+
+// Lowercased ASCII alphanumeric runs. assets/js/search.js tokenizes queries
+// with the same rule; the two must stay in step.
+std::vector<std::string> tokenize(std::string_view text) {
+  static const std::set<std::string, std::less<>> stopwords = {
+    "a", "an", "and", "are", "as", "at", "be", "but", "by", "for", "if", "in", "is", "it",
+    "of", "on", "or", "so", "that", "the", "this", "to", "was", "with",
+  };
+  std::vector<std::string> tokens;
+  std::string cur;
+  for (size_t i = 0; i <= text.size(); ++i) {
+    const unsigned char c = i < text.size() ? text[i] : ' ';
+    if (std::isalnum(c)) {
+      cur += static_cast<char>(std::tolower(c));
+    } else if (!cur.empty()) {
+      if (!stopwords.contains(cur)) tokens.push_back(cur);
+      cur.clear();
+    }
+  }
+  return tokens;
+}
+
+std::string json_string(std::string_view s) {
+  std::string out = "\"";
+  for (char c : s) {
+    switch (c) {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n";  break;
+      case '\t': out += "\\t";  break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof buf, "\\u%04x", c);
+          out += buf;
+        } else {
+          out += c;
+        }
+    }
+  }
+  return out + "\"";
+}
+
+struct SearchDoc {
+  std::string url;
+  std::string title;
+  std::string text;
+};
+
+// The index is JSON so the page can load it with one fetch and no parser of
+// its own, but laid out for a small download and a fast scan:
+//
+//   "docs":  [{ "url", "title", "len", "text" }, ...]   len in tokens, text for snippets
+//   "terms": { term: [df, doc, tf, doc_delta, tf, ...], ... }
+//
+// Postings are sorted by doc id and store the gap from the previous id, so
+// they stay short numbers as the site grows. Terms are written sorted, which
+// lets the client do prefix matching with a binary search.
+std::string search_index(const std::vector<SearchDoc>& docs) {
+  std::map<std::string, std::vector<std::pair<size_t, size_t>>> postings;   // term -> (doc, tf)
+  std::vector<size_t> lengths;
+  for (size_t d = 0; d < docs.size(); ++d) {
+    const auto tokens = tokenize(docs[d].title + " " + docs[d].text);
+    lengths.push_back(tokens.size());
+    std::map<std::string, size_t> tf;
+    for (const auto& t : tokens) ++tf[t];
+    for (const auto& [term, n] : tf) postings[term].emplace_back(d, n);
+  }
+
+  std::string json = "{\n  \"docs\": [\n";
+  for (size_t d = 0; d < docs.size(); ++d) {
+    json += "    { \"url\": " + json_string(docs[d].url) + ", \"title\": " + json_string(docs[d].title) +
+            ", \"len\": " + std::to_string(lengths[d]) + ",\n      \"text\": " + json_string(docs[d].text) + " }";
+    json += d + 1 < docs.size() ? ",\n" : "\n";
+  }
+  json += "  ],\n  \"terms\": {\n";
+  size_t n = 0;
+  for (const auto& [term, list] : postings) {
+    json += "    " + json_string(term) + ": [" + std::to_string(list.size());
+    size_t prev = 0;
+    for (const auto& [doc, tf] : list) {
+      json += "," + std::to_string(doc - prev) + "," + std::to_string(tf);
+      prev = doc;
+    }
+    json += ++n < postings.size() ? "],\n" : "]\n";
+  }
+  return json + "  }\n}\n";
+}
+
+std::vector<SearchDoc> search_docs(const fs::path& root, const std::vector<Post>& posts,
+                                   const std::vector<Project>& projects) {
+  std::vector<SearchDoc> docs;
+  for (const auto& p : posts) {
+    docs.push_back({ "/devlog/posts/" + p.slug, p.meta.at("title"), html_text(p.content) });
+  }
+  for (const auto& p : projects) {
+    std::string text = p.description;
+    for (const auto& t : p.tags) text += " " + t;
+    docs.push_back({ "/portfolio/#" + p.id, p.title, text });
+  }
+  for (const auto& [url, title] : { std::pair{ "/experience", "Experience" }, std::pair{ "/about", "About" } }) {
+    const std::string page = read_file(root / (url + 1) / "index.html");
+    docs.push_back({ url, title, html_text(between(page, "<body", "<main>", "</main>")) });
+  }
+  return docs;
+}
+
+// -- Sitemap -------------------------------------------------------------------
+
+// The URL a page is canonically served at: directories with a trailing
+// slash (GitHub Pages redirects /about to /about/), other pages without .html.
+std::string clean_url(const fs::path& rel) {
+  const std::string s = "/" + rel.generic_string();
+  if (rel.filename() == "index.html") return s.substr(0, s.size() - std::string_view("index.html").size());
+  return s.substr(0, s.size() - std::string_view(".html").size());
+}
+
+// Every page a visitor can navigate to, by site-relative path - the same
+// walk sitebench does: .html files outside dot/underscore dirs and tools/,
+// minus 404.html.
+std::vector<fs::path> site_pages(const fs::path& root) {
+  std::vector<fs::path> pages;
+  for (auto it = fs::recursive_directory_iterator(root); it != fs::recursive_directory_iterator(); ++it) {
+    const fs::path rel = fs::relative(it->path(), root);
+    const std::string name = rel.filename().string();
+    if (it->is_directory() && (name.starts_with(".") || name.starts_with("_") || name == "tools")) {
+      it.disable_recursion_pending();
+      continue;
+    }
+    if (it->is_regular_file() && rel.extension() == ".html" && rel != "404.html") pages.push_back(rel);
+  }
+  std::sort(pages.begin(), pages.end(), [](const fs::path& a, const fs::path& b) { return clean_url(a) < clean_url(b); });
+  return pages;
+}
+
+// Date each page's bytes last changed. Git stores content, so the newest
+// commit touching a file is exactly its last content change; one log walk
+// over the history answers for every page at once. Pages that are new or
+// edited but not yet committed (including ones this run just wrote) fall
+// back to their mtime, which is the day they will be committed.
+std::map<fs::path, std::string> last_modified(const fs::path& root, const std::vector<fs::path>& pages) {
+  const std::string git = "git -C '" + root.string() + "' ";
+  std::map<fs::path, std::string> dates;
+  const std::string log = run(git + "log --format=%x01%cs --name-only --no-renames -- '*.html'");
+  std::string date;
+  for (const auto line : split_lines(log)) {
+    if (line.starts_with('\x01')) date = line.substr(1);
+    else if (!line.empty()) dates.emplace(fs::path(line), date);   // first seen is newest
+  }
+  const std::string status = run(git + "status --porcelain --untracked-files=all -- '*.html'");
+  for (const auto line : split_lines(status)) {
+    if (line.size() > 3) dates.erase(fs::path(line.substr(3)));
+  }
+
+  for (const auto& rel : pages) {
+    if (dates.contains(rel)) continue;
+    const auto mtime = std::chrono::file_clock::to_sys(fs::last_write_time(root / rel));
+    const std::time_t t = std::chrono::system_clock::to_time_t(mtime);
+    char buf[16];
+    std::strftime(buf, sizeof buf, "%Y-%m-%d", std::gmtime(&t));
+    dates[rel] = buf;
+  }
+  return dates;
+}
+
+// robots.txt points crawlers here; with a per-page <lastmod> they can
+// re-fetch only what changed instead of walking the whole site.
+std::string sitemap(const fs::path& root) {
+  const std::string site = site_url(root);
+  const std::vector<fs::path> pages = site_pages(root);
+  const auto dates = last_modified(root, pages);
+
+  std::string xml =
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<!-- Generated by tools/sitebuild from the pages in this repository. -->\n"
+    "<urlset xmlns=\"http://www.sitemaps.org/schemas/sitemap/0.9\">\n";
+  for (const auto& rel : pages) {
+    xml += "  <url>\n"
+           "    <loc>" + html_escape(site + clean_url(rel)) + "</loc>\n"
+           "    <lastmod>" + dates.at(rel) + "</lastmod>\n"
+           "  </url>\n";
+  }
+  return xml + "</urlset>\n";
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char** argv) {
+  const fs::path root = argc > 1 ? argv[1] : ".";
+  int written = 0, unchanged = 0;
+  auto emit = [&](const fs::path& p, const std::string& content) {
+    if (write_if_changed(p, content)) {
+      std::printf("  wrote %s\n", fs::relative(p, root).generic_string().c_str());
+      ++written;
+    } else {
+      ++unchanged;
+    }
+  };
+
+  const std::vector<Post> posts = load_posts(root);
+  for (const auto& post : posts) {
+    if (!post.html.empty()) emit(fs::path(post.source).replace_extension(".html"), post.html);
+  }
+  std::set<fs::path> archive_pages;
+  for (const auto& [path, html] : devlog_index(root, posts)) {
+    emit(path, html);
+    archive_pages.insert(path.parent_path());
+  }
+  // Deleting posts can leave fewer full pages than before
+  if (fs::exists(root / "devlog" / "page")) {
+    for (const auto& dir : fs::directory_iterator(root / "devlog" / "page")) {
+      if (archive_pages.contains(dir.path())) continue;
+      fs::remove_all(dir.path());
+      std::printf("  removed %s\n", fs::relative(dir.path(), root).generic_string().c_str());
+    }
+  }
+  emit(root / "devlog" / "feed.xml", devlog_feed(root, posts));
+
+  const std::vector<Project> projects = load_projects(root);
+  std::set<fs::path> tag_pages;
+  for (const auto& [path, html] : portfolio(root, projects)) {
+    emit(path, html);
+    if (path.parent_path().parent_path() == root / "portfolio" / "tag") tag_pages.insert(path.parent_path());
+  }
+  // A tag no project uses any more takes its page with it
+  if (fs::exists(root / "portfolio" / "tag")) {
+    for (const auto& dir : fs::directory_iterator(root / "portfolio" / "tag")) {
+      if (tag_pages.contains(dir.path())) continue;
+      fs::remove_all(dir.path());
+      std::printf("  removed %s\n", fs::relative(dir.path(), root).generic_string().c_str());
+    }
+  }
+
+  const Resume resume = load_resume(root, projects);
+  emit(root / "experience" / "index.html", experience_page(root, resume));
+  emit(root / "experience" / "resume.pdf", resume_pdf(resume));
+
+  emit(root / "data" / "search.json", search_index(search_docs(root, posts, projects)));
+  // Last, so it sees the pages written above
+  emit(root / "sitemap.xml", sitemap(root));
+
+  std::printf("sitebuild: %d written, %d unchanged\n", written, unchanged);
+  return 0;
+}